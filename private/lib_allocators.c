@@ -0,0 +1,69 @@
+/**
+ * @author Maxence ROBIN
+ * @brief Provides the allocator interface used by containers.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_allocators.h"
+#include "lib_allocators_private.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Callbacks functions -------------------------------------------------------*/
+
+static void *default_alloc(size_t size, void *ctx)
+{
+        return malloc(size);
+}
+
+static void *default_realloc(
+                void *block, size_t old_size, size_t new_size, void *ctx)
+{
+        return realloc(block, new_size);
+}
+
+static void default_free(void *block, size_t size, void *ctx)
+{
+        free(block);
+}
+
+/* Definitions ---------------------------------------------------------------*/
+
+static const struct allocator default_allocator = {
+        .alloc = default_alloc,
+        .realloc = default_realloc,
+        .free = default_free,
+        .ctx = NULL
+};
+
+/* API -----------------------------------------------------------------------*/
+
+const struct allocator *allocator_default(void)
+{
+        return &default_allocator;
+}
+
+/* Private API ---------------------------------------------------------------*/
+
+bool allocator_is_valid(const struct allocator *allocator)
+{
+        return (allocator && allocator->alloc && allocator->free);
+}
+
+void *allocator_calloc(const struct allocator *allocator, size_t size)
+{
+        void *block = allocator->alloc(size, allocator->ctx);
+        if (block)
+                memset(block, 0, size);
+
+        return block;
+}
+
+void allocator_free(
+                const struct allocator *allocator, void *block, size_t size)
+{
+        if (block)
+                allocator->free(block, size, allocator->ctx);
+}
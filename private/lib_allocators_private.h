@@ -0,0 +1,37 @@
+/**
+ * @author Maxence ROBIN
+ * @brief Provides private allocators API.
+ */
+
+#ifndef LIB_ALLOCATORS_PRIVATE_H
+#define LIB_ALLOCATORS_PRIVATE_H
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_allocators.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* API -----------------------------------------------------------------------*/
+
+/**
+ * @brief Indicates if 'allocator' can be given to a container.
+ */
+bool allocator_is_valid(const struct allocator *allocator);
+
+/**
+ * @brief Allocates a zeroed block of 'size' bytes from 'allocator'.
+ *
+ * @return Pointer to the block on success.
+ * @return NULL on failure.
+ */
+void *allocator_calloc(const struct allocator *allocator, size_t size);
+
+/**
+ * @brief Frees 'block', of 'size' bytes, allocated from 'allocator'.
+ */
+void allocator_free(
+                const struct allocator *allocator, void *block, size_t size);
+
+#endif /* LIB_ALLOCATORS_PRIVATE_H */
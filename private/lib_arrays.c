@@ -5,8 +5,11 @@
 
 /* Includes ------------------------------------------------------------------*/
 
+#include "lib_allocators_private.h"
 #include "lib_arrays.h"
 #include "lib_iterators_private.h"
+#include "lib_searches.h"
+#include "lib_sorts.h"
 
 #include <errno.h>
 #include <stdlib.h>
@@ -15,6 +18,7 @@
 /* Definitions ---------------------------------------------------------------*/
 
 struct array {
+        const struct allocator *allocator;
         const struct type_info *type;
         size_t len;
         void *data;
@@ -22,6 +26,7 @@ struct array {
 
 struct array_it {
         struct iterator it; /* Placed at top for inheritance */
+        const struct allocator *allocator; /* May outlive 'array' */
         struct array *array;
         int pos;
 };
@@ -38,16 +43,26 @@ static char *data_offset(const struct array *array, unsigned int pos)
 struct array *array_create(
                 const struct type_info *type, size_t count, void *data)
 {
-        if (!type || !data)
+        return array_create_with(type, count, data, allocator_default());
+}
+
+struct array *array_create_with(
+                const struct type_info *type,
+                size_t count,
+                void *data,
+                const struct allocator *allocator)
+{
+        if (!type || !data || !allocator_is_valid(allocator))
                 return NULL;
 
         if (type->size == 0 || !type->copy || !type->comp || !type->destroy)
                 return NULL;
 
-        struct array *array = malloc(sizeof(*array));
+        struct array *array = allocator_calloc(allocator, sizeof(*array));
         if (!array)
                 return NULL;
 
+        array->allocator = allocator;
         array->type = type;
         array->len = count;
         array->data = data;
@@ -60,7 +75,8 @@ void array_destroy(const void *array)
         if (!array)
                 return;
 
-        free((void *)array);
+        const struct array *a = array;
+        allocator_free(a->allocator, (void *)a, sizeof(*a));
 }
 
 int array_sort(struct array *array)
@@ -68,7 +84,7 @@ int array_sort(struct array *array)
         if (!array)
                 return -EINVAL;
 
-        qsort(array->data, array->len, array->type->size, array->type->comp);
+        sort_typed(array->data, array->len, array->type);
         return 0;
 }
 
@@ -81,6 +97,119 @@ int array_sort_by(struct array *array, type_comp_cb comp)
         return 0;
 }
 
+int array_stable_sort(struct array *array)
+{
+        if (!array)
+                return -EINVAL;
+
+        return sort_stable(array->data, array->len, array->type->size,
+                        array->type->comp);
+}
+
+int array_stable_sort_by(struct array *array, type_comp_cb comp)
+{
+        if (!array || !comp)
+                return -EINVAL;
+
+        return sort_stable(array->data, array->len, array->type->size, comp);
+}
+
+int array_partial_sort(struct array *array, size_t k)
+{
+        if (!array)
+                return -EINVAL;
+
+        if (array->len < k)
+                return -ERANGE;
+
+        sort_partial(array->data, array->len, array->type->size,
+                        array->type->comp, k);
+        return 0;
+}
+
+int array_nth_element(struct array *array, size_t k)
+{
+        if (!array)
+                return -EINVAL;
+
+        if (array->len <= k)
+                return -ERANGE;
+
+        sort_select(array->data, array->len, array->type->size,
+                        array->type->comp, k);
+        return 0;
+}
+
+int array_par_sort(struct array *array, bool stable)
+{
+        if (!array)
+                return -EINVAL;
+
+        return sort_parallel(array->data, array->len, array->type->size,
+                        array->type->comp, stable);
+}
+
+ssize_t array_lower_bound(const struct array *array, const void *value)
+{
+        if (!array || !value)
+                return -EINVAL;
+
+        const struct type_info *type = array->type;
+        const size_t len = array->len;
+        const char *data = array->data;
+
+        return (ssize_t)search_lower_bound(data, len, type->size, type->comp,
+                        value);
+}
+
+ssize_t array_upper_bound(const struct array *array, const void *value)
+{
+        if (!array || !value)
+                return -EINVAL;
+
+        const struct type_info *type = array->type;
+        const size_t len = array->len;
+        const char *data = array->data;
+
+        return (ssize_t)search_upper_bound(data, len, type->size, type->comp,
+                        value);
+}
+
+bool array_binary_search(const struct array *array, const void *value)
+{
+        if (!array || !value)
+                return false;
+
+        const struct type_info *type = array->type;
+        const size_t len = array->len;
+        const char *data = array->data;
+
+        const size_t pos = search_lower_bound(data, len, type->size,
+                        type->comp, value);
+
+        return (pos < len && type->comp(data + pos * type->size, value) == 0);
+}
+
+int array_equal_range(
+                const struct array *array,
+                const void *value,
+                size_t *first,
+                size_t *last)
+{
+        if (!array || !value || !first || !last)
+                return -EINVAL;
+
+        const struct type_info *type = array->type;
+        const size_t len = array->len;
+        const char *data = array->data;
+
+        *first = search_lower_bound(data, len, type->size, type->comp, value);
+        *last = *first + search_upper_bound(data + *first * type->size,
+                        len - *first, type->size, type->comp, value);
+
+        return 0;
+}
+
 ssize_t array_len(const struct array *array)
 {
         if (!array)
@@ -117,11 +246,13 @@ static struct array_it *array_it_create(
                 int pos,
                 const struct iterator_callbacks *cbs)
 {
-        struct array_it *a_it = calloc(1, sizeof(*a_it));
+        struct array_it *a_it = allocator_calloc(array->allocator,
+                        sizeof(*a_it));
         if (!a_it)
                 return NULL;
 
         it_init(&a_it->it, cbs);
+        a_it->allocator = array->allocator;
         a_it->array = (struct array *)array;
         a_it->pos = pos;
 
@@ -191,10 +322,34 @@ static int array_it_copy(struct iterator *dest, const struct iterator *src)
         return 0;
 }
 
+static ssize_t array_it_span(const struct iterator *it, void **data)
+{
+        if (!array_it_is_valid(it))
+                return -EINVAL;
+
+        const struct array_it *a_it = (const struct array_it *)it;
+        *data = data_offset(a_it->array, a_it->pos);
+        return (ssize_t)(a_it->array->len - a_it->pos);
+}
+
+static int array_it_advance(struct iterator *it, ssize_t offset)
+{
+        struct array_it *a_it = (struct array_it *)it;
+        a_it->pos += offset;
+        return 0;
+}
+
+static int array_rit_advance(struct iterator *it, ssize_t offset)
+{
+        struct array_it *a_it = (struct array_it *)it;
+        a_it->pos -= offset;
+        return 0;
+}
+
 static void array_it_destroy(const struct iterator *it)
 {
         struct array_it *a_it = (struct array_it *)it;
-        free(a_it);
+        allocator_free(a_it->allocator, a_it, sizeof(*a_it));
 }
 
 static struct iterator_callbacks array_it_cbs = {
@@ -206,7 +361,9 @@ static struct iterator_callbacks array_it_cbs = {
         .remove_cb = NULL,
         .dup_cb = array_it_dup,
         .copy_cb = array_it_copy,
-        .destroy_cb = array_it_destroy
+        .destroy_cb = array_it_destroy,
+        .span_cb = array_it_span,
+        .advance_cb = array_it_advance
 };
 
 static struct iterator_callbacks array_rit_cbs = {
@@ -218,7 +375,9 @@ static struct iterator_callbacks array_rit_cbs = {
         .remove_cb = NULL,
         .dup_cb = array_it_dup,
         .copy_cb = array_it_copy,
-        .destroy_cb = array_it_destroy
+        .destroy_cb = array_it_destroy,
+        .span_cb = NULL,
+        .advance_cb = array_rit_advance
 };
 
 /* Public API ------------------------*/
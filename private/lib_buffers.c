@@ -5,26 +5,144 @@
 
 /* Includes ------------------------------------------------------------------*/
 
+#define _GNU_SOURCE /* memfd_create() */
+
+#include "lib_allocators_private.h"
 #include "lib_buffers.h"
+#include "lib_iterators_private.h"
 
 #include <errno.h>
-#include <stdlib.h>
+#include <limits.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 /* Definitions ---------------------------------------------------------------*/
 
+/*
+ * Values are stored right after the buffer, unless it is mirrored : its
+ * storage is then mapped twice in a row, so that the slots following the last
+ * one are the first ones again.
+ */
 struct buffer {
+        const struct allocator *allocator;
         const struct type_info *type;
         size_t count;
         unsigned int read;
         unsigned int write;
         enum { BUFFER_NONE, BUFFER_EMPTY, BUFFER_FULL } status;
+        char *data;
+        size_t mirror_size; /* Of each mapping, 0 if not mirrored */
+};
+
+struct buffer_it {
+        struct iterator it; /* Placed at top for inheritance */
+        const struct allocator *allocator; /* May outlive 'buffer' */
+        struct buffer *buffer;
+        ssize_t pos; /* From the first value of 'buffer' */
 };
 
 /* Static functions ----------------------------------------------------------*/
 
 static char *data_offset(const struct buffer *buffer, unsigned int pos)
 {
-        return (char *)(buffer + 1) + buffer->type->size * pos;
+        return buffer->data + buffer->type->size * pos;
+}
+
+static size_t alloc_size(const struct buffer *buffer)
+{
+        if (buffer->mirror_size > 0)
+                return sizeof(*buffer);
+
+        return sizeof(*buffer) + buffer->type->size * buffer->count;
+}
+
+/**
+ * @brief Returns the number of slots of 'buffer' following each other in
+ * memory from 'pos'.
+ */
+static size_t contiguous(const struct buffer *buffer, unsigned int pos)
+{
+        if (buffer->mirror_size > 0)
+                return buffer->count;
+
+        return buffer->count - pos;
+}
+
+/**
+ * @brief Returns the position 'offset' elements after 'pos', wrapping around
+ * the end of 'buffer'.
+ *
+ * @note 'offset' MUST not be greater than the number of elements of 'buffer'.
+ */
+static unsigned int wrap(
+                const struct buffer *buffer, unsigned int pos, size_t offset)
+{
+        const size_t next = pos + offset;
+        return (unsigned int)(next >= buffer->count ? next - buffer->count
+                                                    : next);
+}
+
+static size_t buffer_fill(const struct buffer *buffer)
+{
+        if (buffer->status == BUFFER_FULL)
+                return buffer->count;
+
+        if (buffer->write >= buffer->read)
+                return buffer->write - buffer->read;
+
+        return buffer->count - buffer->read + buffer->write;
+}
+
+/**
+ * @brief Indicates if values of 'type' can be copied bitwise : values owning
+ * nothing to destroy are.
+ */
+static bool is_trivial(const struct type_info *type)
+{
+        return (type->destroy == type_default_destroy);
+}
+
+/**
+ * @brief Copies the 'count' values of 'data' to 'buffer' from 'pos', without
+ * wrapping.
+ */
+static void copy_values(
+                const struct buffer *buffer,
+                unsigned int pos,
+                const char *data,
+                size_t count)
+{
+        const size_t size = buffer->type->size;
+        char *dest = data_offset(buffer, pos);
+
+        if (is_trivial(buffer->type)) {
+                memcpy(dest, data, count * size);
+                return;
+        }
+
+        /* Slots may still hold values moved out, which 'copy' may free */
+        memset(dest, 0, count * size);
+        for (size_t i = 0; i < count; ++i)
+                buffer->type->copy(dest + i * size, data + i * size);
+}
+
+/**
+ * @brief Copies bitwise the first 'count' values of 'buffer' to 'data', in at
+ * most two segments around the end of 'buffer'.
+ */
+static void read_values(const struct buffer *buffer, char *data, size_t count)
+{
+        const size_t size = buffer->type->size;
+        size_t first = contiguous(buffer, buffer->read);
+
+        if (first > count)
+                first = count;
+
+        memcpy(data, data_offset(buffer, buffer->read), first * size);
+        memcpy(data + first * size, data_offset(buffer, 0),
+                        (count - first) * size);
 }
 
 /**
@@ -35,10 +153,8 @@ static char *data_offset(const struct buffer *buffer, unsigned int pos)
  */
 static int push_value(struct buffer *buffer, const void *data)
 {
-        char *offset = data_offset(buffer, buffer->write);
-
-        buffer->type->copy(offset, data);
-        buffer->write = (buffer->write + 1) % buffer->count;
+        copy_values(buffer, buffer->write, data, 1);
+        buffer->write = wrap(buffer, buffer->write, 1);
 
         if (buffer->write == buffer->read) {
                 buffer->status = BUFFER_FULL;
@@ -49,6 +165,42 @@ static int push_value(struct buffer *buffer, const void *data)
         return 0;
 }
 
+/**
+ * @brief Destroys the value at 'index' from the first one of 'buffer', and
+ * moves bitwise the values on its shortest side to fill its slot.
+ */
+static void remove_value(struct buffer *buffer, size_t index)
+{
+        const size_t fill = buffer_fill(buffer);
+        const size_t size = buffer->type->size;
+        unsigned int pos = wrap(buffer, buffer->read, index);
+
+        buffer->type->destroy(data_offset(buffer, pos));
+
+        if (index < fill / 2) {
+                for (size_t i = index; i > 0; --i) {
+                        const unsigned int previous =
+                                        wrap(buffer, buffer->read, i - 1);
+                        memcpy(data_offset(buffer, pos),
+                                        data_offset(buffer, previous), size);
+                        pos = previous;
+                }
+
+                buffer->read = wrap(buffer, buffer->read, 1);
+        } else {
+                for (size_t i = index + 1; i < fill; ++i) {
+                        const unsigned int next = wrap(buffer, pos, 1);
+                        memcpy(data_offset(buffer, pos),
+                                        data_offset(buffer, next), size);
+                        pos = next;
+                }
+
+                buffer->write = pos;
+        }
+
+        buffer->status = (fill == 1 ? BUFFER_EMPTY : BUFFER_NONE);
+}
+
 static void destroy_values(const struct buffer *buffer)
 {
         if (buffer->status == BUFFER_EMPTY)
@@ -57,7 +209,7 @@ static void destroy_values(const struct buffer *buffer)
         unsigned int i = buffer->read;
         do {
                 buffer->type->destroy(data_offset(buffer, i));
-                i = (i + 1) % buffer->count;
+                i = wrap(buffer, i, 1);
         } while (i != buffer->write);
 }
 
@@ -65,23 +217,108 @@ static void destroy_values(const struct buffer *buffer)
 
 struct buffer *buffer_create(const struct type_info *type, size_t count)
 {
+        return buffer_create_with(type, count, allocator_default());
+}
+
+struct buffer *buffer_create_with(
+                const struct type_info *type,
+                size_t count,
+                const struct allocator *allocator)
+{
+        if (!type || count == 0 || !allocator_is_valid(allocator))
+                return NULL;
+
+        if (type->size == 0 || !type->copy || !type->destroy)
+                return NULL;
+
+        struct buffer *buffer = allocator_calloc(allocator,
+                        sizeof(*buffer) + type->size * count);
+        if (!buffer)
+                return NULL;
+
+        buffer->allocator = allocator;
+        buffer->type = type;
+        buffer->count = count;
+        buffer->read = 0;
+        buffer->write = 0;
+        buffer->status = BUFFER_EMPTY;
+        buffer->data = (char *)(buffer + 1);
+        buffer->mirror_size = 0;
+
+        return buffer;
+}
+
+struct buffer *buffer_create_mirrored(
+                const struct type_info *type, size_t count)
+{
+        const struct allocator *allocator = allocator_default();
+
         if (!type || count == 0)
                 return NULL;
 
         if (type->size == 0 || !type->copy || !type->destroy)
                 return NULL;
 
-        struct buffer *buffer = calloc(1, sizeof(*buffer) + type->size * count);
+        /* Each mapping MUST hold a whole number of pages and of values */
+        const size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+        size_t a = page_size;
+        size_t b = type->size;
+        while (b != 0) {
+                const size_t r = a % b;
+                a = b;
+                b = r;
+        }
+
+        const size_t step = page_size / a;
+        count = (count + step - 1) / step * step;
+        if (count > UINT_MAX || count > SIZE_MAX / 2 / type->size)
+                return NULL;
+
+        const size_t size = count * type->size;
+
+        struct buffer *buffer = allocator_calloc(allocator, sizeof(*buffer));
         if (!buffer)
                 return NULL;
 
+        const int fd = memfd_create("buffer", MFD_CLOEXEC);
+        if (fd < 0)
+                goto error_memfd;
+
+        if (ftruncate(fd, (off_t)size) < 0)
+                goto error_truncate;
+
+        /* Reserves the whole range first so that both mappings are adjacent */
+        char *data = mmap(NULL, 2 * size, PROT_NONE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (data == MAP_FAILED)
+                goto error_truncate;
+
+        for (int i = 0; i < 2; ++i) {
+                if (mmap(data + i * size, size, PROT_READ | PROT_WRITE,
+                                MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED)
+                        goto error_map;
+        }
+
+        close(fd);
+
+        buffer->allocator = allocator;
         buffer->type = type;
         buffer->count = count;
         buffer->read = 0;
         buffer->write = 0;
         buffer->status = BUFFER_EMPTY;
+        buffer->data = data;
+        buffer->mirror_size = size;
 
         return buffer;
+
+error_map:
+        munmap(data, 2 * size);
+error_truncate:
+        close(fd);
+error_memfd:
+        allocator_free(allocator, buffer, sizeof(*buffer));
+        return NULL;
 }
 
 void buffer_destroy(const struct buffer *buffer)
@@ -90,7 +327,11 @@ void buffer_destroy(const struct buffer *buffer)
                 return;
 
         destroy_values(buffer);
-        free((void *)buffer);
+
+        if (buffer->mirror_size > 0)
+                munmap(buffer->data, 2 * buffer->mirror_size);
+
+        allocator_free(buffer->allocator, (void *)buffer, alloc_size(buffer));
 }
 
 int buffer_push(struct buffer *buffer, const void *data)
@@ -109,8 +350,10 @@ int buffer_f_push(struct buffer *buffer, const void *data)
         if (!buffer || !data)
                 return -EINVAL;
 
-        if (buffer->status == BUFFER_FULL)
-                buffer->read = (buffer->read + 1) % buffer->count;
+        if (buffer->status == BUFFER_FULL) {
+                buffer->type->destroy(data_offset(buffer, buffer->read));
+                buffer->read = wrap(buffer, buffer->read, 1);
+        }
 
         return push_value(buffer, data);
 }
@@ -124,7 +367,7 @@ int buffer_pop(struct buffer *buffer)
                 return -ENOMEM;
 
         buffer->type->destroy(data_offset(buffer, buffer->read));
-        buffer->read = (buffer->read + 1) % buffer->count;
+        buffer->read = wrap(buffer, buffer->read, 1);
 
         if (buffer->read == buffer->write) {
                 buffer->status = BUFFER_EMPTY;
@@ -135,6 +378,148 @@ int buffer_pop(struct buffer *buffer)
         return 0;
 }
 
+ssize_t buffer_push_n(struct buffer *buffer, const void *data, size_t n)
+{
+        if (!buffer || !data)
+                return -EINVAL;
+
+        const size_t left = buffer->count - buffer_fill(buffer);
+        if (n > left)
+                n = left;
+
+        if (n == 0)
+                return 0;
+
+        size_t first = contiguous(buffer, buffer->write);
+        if (first > n)
+                first = n;
+
+        copy_values(buffer, buffer->write, data, first);
+        copy_values(buffer, 0, (const char *)data + first * buffer->type->size,
+                        n - first);
+
+        buffer->write = wrap(buffer, buffer->write, n);
+        buffer->status = (n == left ? BUFFER_FULL : BUFFER_NONE);
+
+        return (ssize_t)n;
+}
+
+ssize_t buffer_pop_n(struct buffer *buffer, void *data, size_t n)
+{
+        if (!buffer)
+                return -EINVAL;
+
+        const size_t fill = buffer_fill(buffer);
+        if (n > fill)
+                n = fill;
+
+        if (data) {
+                read_values(buffer, data, n);
+        } else {
+                unsigned int pos = buffer->read;
+                for (size_t i = 0; i < n; ++i, pos = wrap(buffer, pos, 1))
+                        buffer->type->destroy(data_offset(buffer, pos));
+        }
+
+        if (n > 0) {
+                buffer->read = wrap(buffer, buffer->read, n);
+                buffer->status = (n == fill ? BUFFER_EMPTY : BUFFER_NONE);
+        }
+
+        return (ssize_t)n;
+}
+
+ssize_t buffer_peek_n(const struct buffer *buffer, void *data, size_t n)
+{
+        if (!buffer || !data)
+                return -EINVAL;
+
+        const size_t fill = buffer_fill(buffer);
+        if (n > fill)
+                n = fill;
+
+        read_values(buffer, data, n);
+        return (ssize_t)n;
+}
+
+ssize_t buffer_read_span(const struct buffer *buffer, const void **data)
+{
+        if (!buffer || !data)
+                return -EINVAL;
+
+        size_t len = buffer_fill(buffer);
+        if (len > contiguous(buffer, buffer->read))
+                len = contiguous(buffer, buffer->read);
+
+        *data = data_offset(buffer, buffer->read);
+        return (ssize_t)len;
+}
+
+ssize_t buffer_write_span(struct buffer *buffer, void **data)
+{
+        if (!buffer || !data)
+                return -EINVAL;
+
+        size_t len = buffer->count - buffer_fill(buffer);
+        if (len > contiguous(buffer, buffer->write))
+                len = contiguous(buffer, buffer->write);
+
+        *data = data_offset(buffer, buffer->write);
+        return (ssize_t)len;
+}
+
+int buffer_commit(struct buffer *buffer, size_t n)
+{
+        if (!buffer)
+                return -EINVAL;
+
+        const size_t left = buffer->count - buffer_fill(buffer);
+        if (n > left || n > contiguous(buffer, buffer->write))
+                return -ENOBUFS;
+
+        if (n == 0)
+                return 0;
+
+        buffer->write = wrap(buffer, buffer->write, n);
+        buffer->status = (n == left ? BUFFER_FULL : BUFFER_NONE);
+
+        return 0;
+}
+
+void *buffer_reserve(struct buffer *buffer, size_t n)
+{
+        void *data;
+
+        const ssize_t len = buffer_write_span(buffer, &data);
+        if (len < 0 || n == 0 || (size_t)len < n)
+                return NULL;
+
+        return data;
+}
+
+const void *buffer_acquire(const struct buffer *buffer, size_t n)
+{
+        const void *data;
+
+        const ssize_t len = buffer_read_span(buffer, &data);
+        if (len < 0 || n == 0 || (size_t)len < n)
+                return NULL;
+
+        return data;
+}
+
+int buffer_release(struct buffer *buffer, size_t n)
+{
+        if (!buffer)
+                return -EINVAL;
+
+        if (n > buffer_fill(buffer))
+                return -ENOMEM;
+
+        buffer_pop_n(buffer, NULL, n);
+        return 0;
+}
+
 int buffer_clear(struct buffer *buffer)
 {
         if (!buffer)
@@ -171,6 +556,22 @@ bool buffer_is_full(const struct buffer *buffer)
         return (buffer->status == BUFFER_FULL);
 }
 
+void *buffer_at(const struct buffer *buffer, size_t pos)
+{
+        if (!buffer || pos >= buffer_fill(buffer))
+                return NULL;
+
+        return data_offset(buffer, wrap(buffer, buffer->read, pos));
+}
+
+ssize_t buffer_len(const struct buffer *buffer)
+{
+        if (!buffer)
+                return -EINVAL;
+
+        return (ssize_t)buffer_fill(buffer);
+}
+
 ssize_t buffer_count(const struct buffer *buffer)
 {
         if (!buffer)
@@ -178,3 +579,219 @@ ssize_t buffer_count(const struct buffer *buffer)
 
         return (ssize_t)buffer->count;
 }
+
+/* Iterator API --------------------------------------------------------------*/
+
+static struct iterator_callbacks buffer_it_cbs;
+static struct iterator_callbacks buffer_rit_cbs;
+
+/* Utility functions -----------------*/
+
+static struct buffer_it *buffer_it_create(
+                const struct buffer *buffer,
+                ssize_t pos,
+                const struct iterator_callbacks *cbs)
+{
+        struct buffer_it *b_it = allocator_calloc(buffer->allocator,
+                        sizeof(*b_it));
+        if (!b_it)
+                return NULL;
+
+        it_init(&b_it->it, cbs);
+        b_it->allocator = buffer->allocator;
+        b_it->buffer = (struct buffer *)buffer;
+        b_it->pos = pos;
+
+        return b_it;
+}
+
+/* Iterator implementation -----------*/
+
+static int buffer_it_next(struct iterator *it)
+{
+        struct buffer_it *b_it = (struct buffer_it *)it;
+        ++b_it->pos;
+        return 0;
+}
+
+static int buffer_it_previous(struct iterator *it)
+{
+        struct buffer_it *b_it = (struct buffer_it *)it;
+        --b_it->pos;
+        return 0;
+}
+
+static bool buffer_it_is_valid(const struct iterator *it)
+{
+        const struct buffer_it *b_it = (const struct buffer_it *)it;
+        return (0 <= b_it->pos
+                        && (size_t)b_it->pos < buffer_fill(b_it->buffer));
+}
+
+static void *buffer_it_data(const struct iterator *it)
+{
+        if (!buffer_it_is_valid(it))
+                return NULL;
+
+        const struct buffer_it *b_it = (const struct buffer_it *)it;
+        return buffer_at(b_it->buffer, (size_t)b_it->pos);
+}
+
+static const struct type_info *buffer_it_type(const struct iterator *it)
+{
+        const struct buffer_it *b_it = (const struct buffer_it *)it;
+        return b_it->buffer->type;
+}
+
+static int buffer_it_remove(struct iterator *it)
+{
+        if (!buffer_it_is_valid(it))
+                return -EINVAL;
+
+        struct buffer_it *b_it = (struct buffer_it *)it;
+        remove_value(b_it->buffer, (size_t)b_it->pos);
+
+        return 0;
+}
+
+static int buffer_rit_remove(struct iterator *it)
+{
+        if (!buffer_it_is_valid(it))
+                return -EINVAL;
+
+        struct buffer_it *b_it = (struct buffer_it *)it;
+        remove_value(b_it->buffer, (size_t)b_it->pos);
+        --b_it->pos;
+
+        return 0;
+}
+
+static struct iterator *buffer_it_dup(const struct iterator *it)
+{
+        if (!buffer_it_is_valid(it))
+                return NULL;
+
+        const struct buffer_it *b_it = (const struct buffer_it *)it;
+        struct buffer_it *dup =
+                        buffer_it_create(b_it->buffer, b_it->pos, b_it->it.cbs);
+        return (struct iterator *)dup;
+}
+
+static int buffer_it_copy(struct iterator *dest, const struct iterator *src)
+{
+        if (!buffer_it_is_valid(dest) || !buffer_it_is_valid(src))
+                return -EINVAL;
+
+        struct buffer_it *b_dest = (struct buffer_it *)dest;
+        const struct buffer_it *b_src = (const struct buffer_it *)src;
+
+        if (b_dest->buffer != b_src->buffer)
+                return -EINVAL;
+
+        b_dest->pos = b_src->pos;
+        return 0;
+}
+
+static ssize_t buffer_it_span(const struct iterator *it, void **data)
+{
+        if (!buffer_it_is_valid(it))
+                return -EINVAL;
+
+        const struct buffer_it *b_it = (const struct buffer_it *)it;
+        const struct buffer *buffer = b_it->buffer;
+        const unsigned int pos = wrap(buffer, buffer->read, (size_t)b_it->pos);
+        const size_t len = buffer_fill(buffer) - (size_t)b_it->pos;
+
+        /* Values wrapping around the end of 'buffer' are not contiguous */
+        if (len > contiguous(buffer, pos))
+                return -ENOTSUP;
+
+        *data = data_offset(buffer, pos);
+        return (ssize_t)len;
+}
+
+static int buffer_it_advance(struct iterator *it, ssize_t offset)
+{
+        struct buffer_it *b_it = (struct buffer_it *)it;
+        b_it->pos += offset;
+        return 0;
+}
+
+static int buffer_rit_advance(struct iterator *it, ssize_t offset)
+{
+        struct buffer_it *b_it = (struct buffer_it *)it;
+        b_it->pos -= offset;
+        return 0;
+}
+
+static void buffer_it_destroy(const struct iterator *it)
+{
+        struct buffer_it *b_it = (struct buffer_it *)it;
+        allocator_free(b_it->allocator, b_it, sizeof(*b_it));
+}
+
+static struct iterator_callbacks buffer_it_cbs = {
+        .next_cb = buffer_it_next,
+        .previous_cb = buffer_it_previous,
+        .is_valid_cb = buffer_it_is_valid,
+        .data_cb = buffer_it_data,
+        .type_cb = buffer_it_type,
+        .remove_cb = buffer_it_remove,
+        .dup_cb = buffer_it_dup,
+        .copy_cb = buffer_it_copy,
+        .destroy_cb = buffer_it_destroy,
+        .span_cb = buffer_it_span,
+        .advance_cb = buffer_it_advance
+};
+
+static struct iterator_callbacks buffer_rit_cbs = {
+        .next_cb = buffer_it_previous,
+        .previous_cb = buffer_it_next,
+        .is_valid_cb = buffer_it_is_valid,
+        .data_cb = buffer_it_data,
+        .type_cb = buffer_it_type,
+        .remove_cb = buffer_rit_remove,
+        .dup_cb = buffer_it_dup,
+        .copy_cb = buffer_it_copy,
+        .destroy_cb = buffer_it_destroy,
+        .span_cb = NULL,
+        .advance_cb = buffer_rit_advance
+};
+
+/* Public API ------------------------*/
+
+struct iterator *buffer_begin(const struct buffer *buffer)
+{
+        if (!buffer)
+                return NULL;
+
+        return (struct iterator *)buffer_it_create(buffer, 0, &buffer_it_cbs);
+}
+
+struct iterator *buffer_end(const struct buffer *buffer)
+{
+        if (!buffer)
+                return NULL;
+
+        const ssize_t last = (ssize_t)buffer_fill(buffer) - 1;
+        return (struct iterator *)buffer_it_create(
+                        buffer, last, &buffer_it_cbs);
+}
+
+struct iterator *buffer_rbegin(const struct buffer *buffer)
+{
+        if (!buffer)
+                return NULL;
+
+        const ssize_t last = (ssize_t)buffer_fill(buffer) - 1;
+        return (struct iterator *)buffer_it_create(
+                        buffer, last, &buffer_rit_cbs);
+}
+
+struct iterator *buffer_rend(const struct buffer *buffer)
+{
+        if (!buffer)
+                return NULL;
+
+        return (struct iterator *)buffer_it_create(buffer, 0, &buffer_rit_cbs);
+}
@@ -6,8 +6,14 @@
 /* Includes ------------------------------------------------------------------*/
 
 #include "lib_container_algos.h"
+#include "lib_iterators_private.h"
+#include "lib_simd.h"
+#include "lib_sorts.h"
+#include "lib_threads.h"
+#include "lib_vectors.h"
 
 #include <errno.h>
+#include <stdlib.h>
 
 /* Definitions ---------------------------------------------------------------*/
 
@@ -28,6 +34,36 @@ enum comp_type {
         COMP_TYPE_MAX
 };
 
+/* Parallel algorithms ---------------*/
+
+#define PAR_TASKS_PER_THREAD 4 /* Smooths the load between threads */
+#define PAR_MIN_SPAN_LEN 4096 /* Below this, a task costs more than it earns */
+
+/**
+ * @brief Describes a parallel algorithm split in 'parts' tasks. Each task
+ * works either on a range of contiguous elements when 'data' is not NULL, or
+ * on a slice of the elements seen by 'it'.
+ */
+struct par_job {
+        struct iterator *it;
+        const struct type_info *type;
+        enum simd_kind kind;
+        char *data;
+        size_t len;
+        size_t parts;
+
+        ctn_action_cb action;
+        ctn_match_cb match;
+        void *arg;
+        const void *value;
+        enum comp_type comp_type;
+
+        ssize_t *results; /* Error, count or position found by each task */
+        struct iterator **slices; /* Elements of each task, when split */
+        struct iterator **found; /* Element found by each task over a slice */
+        bool track; /* Tasks over slices track an element in 'found' */
+};
+
 /* Callbacks functions -------------------------------------------------------*/
 
 static bool match_equal(const void *value, void *arg)
@@ -45,6 +81,44 @@ static void fill(void *dest, void *arg)
 
 /* Static functions ----------------------------------------------------------*/
 
+/**
+ * @brief Indicates if the elements starting from 'it' can be handled by
+ * vectorized kernels, and if so sets 'data' and 'len' to their location.
+ *
+ * @return The kernel kind to use on success.
+ * @return SIMD_KIND_NONE if the generic callbacks must be used.
+ */
+static enum simd_kind simd_span(
+                const struct iterator *it, void **data, size_t *len)
+{
+        const enum simd_kind kind = simd_kind(it_type(it));
+        if (kind == SIMD_KIND_NONE)
+                return SIMD_KIND_NONE;
+
+        const ssize_t count = it_span(it, data);
+        if (count < 0)
+                return SIMD_KIND_NONE;
+
+        *len = (size_t)count;
+        return kind;
+}
+
+/**
+ * @brief Returns a duplicate of 'it' moved of 'pos' elements.
+ *
+ * @return Pointer to the iterator on success.
+ * @return NULL on failure.
+ */
+static struct iterator *dup_at(const struct iterator *it, size_t pos)
+{
+        struct iterator *dup = it_dup(it);
+        if (!dup)
+                return NULL;
+
+        it_advance(dup, (ssize_t)pos);
+        return dup;
+}
+
 static int for_each(struct iterator *it, ctn_action_cb action, void *arg)
 {
         struct iterator *dup = it_dup(it);
@@ -141,9 +215,85 @@ static bool contains_if(struct iterator *it, ctn_match_cb match, void *arg)
         }
 }
 
+static int count(struct iterator *it, const void *value)
+{
+        void *data;
+        size_t len;
+
+        const enum simd_kind kind = simd_span(it, &data, &len);
+        if (kind != SIMD_KIND_NONE)
+                return (int)simd_count(kind, data, len, value);
+
+        return count_if(it, match_equal, &(struct match_equal_ctx) {
+                .type = it_type(it),
+                .value = value
+        });
+}
+
+static struct iterator *find(struct iterator *it, const void *value)
+{
+        void *data;
+        size_t len;
+
+        const enum simd_kind kind = simd_span(it, &data, &len);
+        if (kind != SIMD_KIND_NONE) {
+                const size_t pos = simd_find(kind, data, len, value);
+                return (pos < len ? dup_at(it, pos) : NULL);
+        }
+
+        return find_if(it, match_equal, &(struct match_equal_ctx) {
+                .type = it_type(it),
+                .value = value
+        });
+}
+
+static int fill_values(struct iterator *it, const void *value)
+{
+        void *data;
+        size_t len;
+
+        const enum simd_kind kind = simd_span(it, &data, &len);
+        if (kind != SIMD_KIND_NONE) {
+                simd_fill(kind, data, len, value);
+                return 0;
+        }
+
+        return for_each(it, fill, &(struct fill_ctx) {
+                .type = it_type(it),
+                .value = value
+        });
+}
+
+/**
+ * @brief Indicates if 'first' should replace 'second' as the element found by
+ * a min or max search.
+ */
+static bool is_better(
+                const struct type_info *type,
+                const void *first,
+                const void *second,
+                enum comp_type comp_type)
+{
+        const int res = type->comp(first, second);
+        return ((comp_type == COMP_TYPE_MIN && res < 0)
+                        || (comp_type == COMP_TYPE_MAX && res > 0));
+}
+
 static struct iterator *min_max(struct iterator *it, enum comp_type comp_type)
 {
         struct iterator *found = NULL;
+        void *data;
+        size_t len;
+
+        const enum simd_kind kind = simd_span(it, &data, &len);
+        if (kind != SIMD_KIND_NONE) {
+                const ssize_t pos = simd_min_max(kind, data, len,
+                                comp_type == COMP_TYPE_MAX);
+
+                /* On failure, the generic version handles special values */
+                if (pos >= 0)
+                        return dup_at(it, (size_t)pos);
+        }
 
         struct iterator *dup = it_dup(it);
         if (!dup)
@@ -158,11 +308,8 @@ static struct iterator *min_max(struct iterator *it, enum comp_type comp_type)
 
         const struct type_info *type = it_type(it);
         do {
-                const int res = type->comp(it_data(dup), it_data(found));
-                if ((comp_type == COMP_TYPE_MIN && res < 0)
-                                || (comp_type == COMP_TYPE_MAX && res > 0)) {
+                if (is_better(type, it_data(dup), it_data(found), comp_type))
                         it_copy(found, dup);
-                }
 
                 it_next(dup);
         } while (it_is_valid(dup));
@@ -185,6 +332,435 @@ static int copy_min_max(
         return 0;
 }
 
+/**
+ * @brief Returns the type of the elements of 'vector'.
+ *
+ * @return The type of 'vector' on success.
+ * @return NULL if 'vector' is invalid or on failure.
+ */
+static const struct type_info *vector_type(const void *vector)
+{
+        struct iterator *it = vector_begin(vector);
+        const struct type_info *type = it_type(it);
+
+        it_unref(it);
+        return type;
+}
+
+/**
+ * @brief Replaces the content of 'vector' with the 'k' greatest elements
+ * starting from 'it'. They are kept in a min heap of at most 'k' elements
+ * while iterating, its top being the element to evict next, then sorted in
+ * descending order.
+ *
+ * @return Pointer to a valid vector, if it was modified or not.
+ *
+ * @note If 'ret' is not NULL, its value will be modified to indicate if the
+ * operation was successful or not :
+ *      0 on success.
+ *      -ENOMEM on failure.
+ */
+static void *top_k(struct iterator *it, size_t k, void *vector, int *ret)
+{
+        const struct type_info *type = it_type(it);
+        size_t len = 0;
+        int res = 0;
+
+        vector_clear(vector);
+        if (k == 0)
+                goto out;
+
+        struct iterator *dup = it_dup(it);
+        if (!dup) {
+                res = -ENOMEM;
+                goto out;
+        }
+
+        while (it_is_valid(dup)) {
+                const void *data = it_data(dup);
+
+                if (len < k) {
+                        vector = vector_push(vector, data, &res);
+                        if (res < 0)
+                                goto error_push;
+
+                        heap_push(vector, ++len, type->size, type->comp,
+                                        HEAP_ORDER_MIN);
+                } else if (type->comp(data, vector) > 0) {
+                        type->copy(vector, data);
+                        heap_fix_top(vector, len, type->size, type->comp,
+                                        HEAP_ORDER_MIN);
+                }
+
+                it_next(dup);
+        }
+
+        heap_sort(vector, len, type->size, type->comp, HEAP_ORDER_MIN);
+error_push:
+        it_unref(dup);
+out:
+        if (ret)
+                *ret = res;
+
+        return vector;
+}
+
+/* Parallel static functions -------------------------------------------------*/
+
+static void par_clean(const struct par_job *job)
+{
+        for (size_t i = 0; job->slices && i < job->parts; ++i)
+                it_unref(job->slices[i]);
+
+        for (size_t i = 0; job->found && i < job->parts; ++i)
+                it_unref(job->found[i]);
+
+        free(job->found);
+        free(job->slices);
+        free(job->results);
+}
+
+/**
+ * @brief Creates the iterators used by the tasks of 'job' over slices. They
+ * are created from the calling thread, so that tasks never call the allocator
+ * of the container, which may not be thread-safe.
+ *
+ * @return 0 on success.
+ * @return -ENOMEM on failure.
+ */
+static int par_slice(struct par_job *job)
+{
+        for (size_t i = 0; i < job->parts; ++i) {
+                job->slices[i] = it_slice(job->it, i, job->parts);
+                if (!job->slices[i])
+                        return -ENOMEM;
+
+                if (!job->track)
+                        continue;
+
+                job->found[i] = it_slice(job->it, i, job->parts);
+                if (!job->found[i])
+                        return -ENOMEM;
+        }
+
+        return 0;
+}
+
+/**
+ * @brief Prepares 'job' to run over the elements starting from 'it'.
+ *
+ * @return 0 on success.
+ * @return -ENOTSUP if the elements can not be handled in parallel, in which
+ * case the sequential version of the algorithm should be used.
+ * @return -ENOMEM on failure.
+ */
+static int par_init(struct par_job *job, struct iterator *it)
+{
+        const size_t threads = threads_count();
+        void *data;
+
+        job->it = it;
+        job->type = it_type(it);
+
+        const ssize_t len = it_span(it, &data);
+        if (len >= 0) {
+                job->kind = simd_kind(job->type);
+                job->data = data;
+                job->len = len;
+                job->parts = len / PAR_MIN_SPAN_LEN;
+        } else if (it_can_slice(it) && it_is_valid(it)) {
+                job->kind = SIMD_KIND_NONE;
+                job->data = NULL;
+                job->len = 0;
+                job->parts = threads * PAR_TASKS_PER_THREAD;
+        } else {
+                return -ENOTSUP;
+        }
+
+        if (job->parts > threads * PAR_TASKS_PER_THREAD)
+                job->parts = threads * PAR_TASKS_PER_THREAD;
+
+        if (threads <= 1 || job->parts <= 1)
+                return -ENOTSUP;
+
+        job->results = calloc(job->parts, sizeof(*job->results));
+        job->slices = calloc(job->parts, sizeof(*job->slices));
+        job->found = calloc(job->parts, sizeof(*job->found));
+        if (!job->results || !job->slices || !job->found)
+                goto error;
+
+        if (!job->data && par_slice(job) < 0)
+                goto error;
+
+        return 0;
+
+error:
+        par_clean(job);
+        return -ENOMEM;
+}
+
+/**
+ * @brief Returns the first error reported by the tasks of 'job'.
+ *
+ * @return 0 if all tasks succeeded.
+ * @return A negative error code otherwise.
+ */
+static int par_error(const struct par_job *job)
+{
+        for (size_t i = 0; i < job->parts; ++i) {
+                if (job->results[i] < 0)
+                        return (int)job->results[i];
+        }
+
+        return 0;
+}
+
+static void par_bounds(
+                const struct par_job *job,
+                size_t index,
+                size_t *first,
+                size_t *last)
+{
+        *first = job->len * index / job->parts;
+        *last = job->len * (index + 1) / job->parts;
+}
+
+static char *par_data(const struct par_job *job, size_t pos)
+{
+        return job->data + pos * job->type->size;
+}
+
+/* Tasks -----------------------------*/
+
+static void par_for_each_task(size_t index, void *arg)
+{
+        struct par_job *job = arg;
+        size_t first, last;
+
+        if (job->data) {
+                par_bounds(job, index, &first, &last);
+                for (size_t i = first; i < last; ++i)
+                        job->action(par_data(job, i), job->arg);
+
+                return;
+        }
+
+        /* The slice belongs to this task, it is walked without a copy */
+        struct iterator *slice = job->slices[index];
+        while (it_is_valid(slice)) {
+                job->action(it_data(slice), job->arg);
+                it_next(slice);
+        }
+}
+
+static void par_fill_task(size_t index, void *arg)
+{
+        struct par_job *job = arg;
+        size_t first, last;
+
+        if (job->data && job->kind != SIMD_KIND_NONE) {
+                par_bounds(job, index, &first, &last);
+                simd_fill(job->kind, par_data(job, first), last - first,
+                                job->value);
+                return;
+        }
+
+        par_for_each_task(index, arg);
+}
+
+static void par_count_if_task(size_t index, void *arg)
+{
+        struct par_job *job = arg;
+        size_t first, last;
+
+        if (job->data) {
+                par_bounds(job, index, &first, &last);
+                for (size_t i = first; i < last; ++i) {
+                        if (job->match(par_data(job, i), job->arg))
+                                ++job->results[index];
+                }
+
+                return;
+        }
+
+        struct iterator *slice = job->slices[index];
+        while (it_is_valid(slice)) {
+                if (job->match(it_data(slice), job->arg))
+                        ++job->results[index];
+
+                it_next(slice);
+        }
+}
+
+static void par_min_max_task(size_t index, void *arg)
+{
+        struct par_job *job = arg;
+        size_t first, last;
+
+        if (job->data) {
+                par_bounds(job, index, &first, &last);
+
+                ssize_t pos = -EDOM;
+                if (job->kind != SIMD_KIND_NONE)
+                        pos = simd_min_max(job->kind, par_data(job, first),
+                                        last - first,
+                                        job->comp_type == COMP_TYPE_MAX);
+
+                if (pos >= 0) {
+                        job->results[index] = first + pos;
+                        return;
+                }
+
+                size_t best = first;
+                for (size_t i = first + 1; i < last; ++i) {
+                        if (is_better(job->type, par_data(job, i),
+                                        par_data(job, best), job->comp_type))
+                                best = i;
+                }
+
+                job->results[index] = best;
+                return;
+        }
+
+        /* 'found' starts on the first element of the slice */
+        struct iterator *slice = job->slices[index];
+        struct iterator *found = job->found[index];
+        while (it_is_valid(slice)) {
+                if (is_better(job->type, it_data(slice), it_data(found),
+                                job->comp_type))
+                        it_copy(found, slice);
+
+                it_next(slice);
+        }
+}
+
+/* Algorithms ------------------------*/
+
+static int par_for_each(struct iterator *it, ctn_action_cb action, void *arg)
+{
+        struct par_job job = {
+                .action = action,
+                .arg = arg
+        };
+
+        int res = par_init(&job, it);
+        if (res == -ENOTSUP)
+                return for_each(it, action, arg);
+        else if (res < 0)
+                return res;
+
+        threads_run(job.parts, par_for_each_task, &job);
+
+        res = par_error(&job);
+        par_clean(&job);
+        return res;
+}
+
+static int par_fill(struct iterator *it, const void *value)
+{
+        struct fill_ctx ctx = {
+                .type = it_type(it),
+                .value = value
+        };
+        struct par_job job = {
+                .action = fill,
+                .arg = &ctx,
+                .value = value
+        };
+
+        int res = par_init(&job, it);
+        if (res == -ENOTSUP)
+                return fill_values(it, value);
+        else if (res < 0)
+                return res;
+
+        threads_run(job.parts, par_fill_task, &job);
+
+        res = par_error(&job);
+        par_clean(&job);
+        return res;
+}
+
+static int par_count_if(struct iterator *it, ctn_match_cb match, void *arg)
+{
+        struct par_job job = {
+                .match = match,
+                .arg = arg
+        };
+
+        int res = par_init(&job, it);
+        if (res == -ENOTSUP)
+                return count_if(it, match, arg);
+        else if (res < 0)
+                return res;
+
+        threads_run(job.parts, par_count_if_task, &job);
+
+        /* Errors take precedence over partial counts */
+        res = par_error(&job);
+        if (res == 0) {
+                for (size_t i = 0; i < job.parts; ++i)
+                        res += job.results[i];
+        }
+
+        par_clean(&job);
+        return res;
+}
+
+static struct iterator *par_min_max(
+                struct iterator *it, enum comp_type comp_type)
+{
+        struct iterator *found = NULL;
+        struct par_job job = {
+                .comp_type = comp_type,
+                .track = true
+        };
+
+        const int res = par_init(&job, it);
+        if (res == -ENOTSUP)
+                return min_max(it, comp_type);
+        else if (res < 0)
+                return NULL;
+
+        threads_run(job.parts, par_min_max_task, &job);
+        if (par_error(&job) < 0)
+                goto out;
+
+        /*
+         * Tasks results are reduced following the iteration order, so the
+         * element found is the same as the one of the sequential version.
+         */
+        if (job.data) {
+                size_t best = job.results[0];
+                for (size_t i = 1; i < job.parts; ++i) {
+                        if (is_better(job.type, par_data(&job, job.results[i]),
+                                        par_data(&job, best), comp_type))
+                                best = job.results[i];
+                }
+
+                found = dup_at(it, best);
+                goto out;
+        }
+
+        const struct iterator *best = NULL;
+        for (size_t i = 0; i < job.parts; ++i) {
+                if (!it_is_valid(job.found[i]))
+                        continue;
+
+                if (!best || is_better(job.type, it_data(job.found[i]),
+                                it_data(best), comp_type))
+                        best = job.found[i];
+        }
+
+        /* Slices are bounded, the result is a copy of 'it' set on 'best' */
+        found = it_dup(it);
+        if (found && best)
+                it_copy(found, best);
+out:
+        par_clean(&job);
+        return found;
+}
+
 /* API -----------------------------------------------------------------------*/
 
 int ctn_for_each(struct iterator *it, ctn_action_cb action, void *arg)
@@ -205,10 +781,7 @@ int ctn_count(struct iterator *it, const void *value)
         if (!it || !value)
                 goto out;
 
-        res = count_if(it, match_equal, &(struct match_equal_ctx) {
-                .type = it_type(it),
-                .value = value
-        });
+        res = count(it, value);
 out:
         it_unref(it);
         return res;
@@ -232,10 +805,7 @@ struct iterator *ctn_find(struct iterator *it, const void *value)
         if (!it || !value)
                 goto out;
 
-        res = find_if(it, match_equal, &(struct match_equal_ctx) {
-                .type = it_type(it),
-                .value = value
-        });
+        res = find(it, value);
 out:
         it_unref(it);
         return res;
@@ -313,10 +883,9 @@ bool ctn_contains(struct iterator *it, const void *value)
         if (!it || !value)
                 goto out;
 
-        res = contains_if(it, match_equal, &(struct match_equal_ctx) {
-                .type = it_type(it),
-                .value = value
-        });
+        struct iterator *found = find(it, value);
+        res = (found != NULL);
+        it_unref(found);
 out:
         it_unref(it);
         return res;
@@ -340,10 +909,11 @@ int ctn_fill(struct iterator *it, const void *value)
         if (!it || !value)
                 goto out;
 
-        res = for_each(it, fill, &(struct fill_ctx) {
-                .type = it_type(it),
-                .value = value
-        });
+        res = -ENOTSUP;
+        if (!it_can_overwrite(it))
+                goto out;
+
+        res = fill_values(it, value);
 out:
         it_unref(it);
         return res;
@@ -396,3 +966,89 @@ out:
         it_unref(it);
         return res;
 }
+
+void *ctn_top_k(struct iterator *it, size_t k, void *vector, int *ret)
+{
+        if (!it || vector_type(vector) != it_type(it)) {
+                if (ret)
+                        *ret = -EINVAL;
+
+                goto out;
+        }
+
+        vector = top_k(it, k, vector, ret);
+out:
+        it_unref(it);
+        return vector;
+}
+
+/* Parallel API --------------------------------------------------------------*/
+
+int ctn_set_thread_count(unsigned int count)
+{
+        return threads_set_count(count);
+}
+
+int ctn_par_for_each(struct iterator *it, ctn_action_cb action, void *arg)
+{
+        int res = -EINVAL;
+        if (!it || !action)
+                goto out;
+
+        res = par_for_each(it, action, arg);
+out:
+        it_unref(it);
+        return res;
+}
+
+int ctn_par_count_if(struct iterator *it, ctn_match_cb match, void *arg)
+{
+        int res = -EINVAL;
+        if (!it || !match)
+                goto out;
+
+        res = par_count_if(it, match, arg);
+out:
+        it_unref(it);
+        return res;
+}
+
+int ctn_par_fill(struct iterator *it, const void *value)
+{
+        int res = -EINVAL;
+        if (!it || !value)
+                goto out;
+
+        res = -ENOTSUP;
+        if (!it_can_overwrite(it))
+                goto out;
+
+        res = par_fill(it, value);
+out:
+        it_unref(it);
+        return res;
+}
+
+struct iterator *ctn_par_min(struct iterator *it)
+{
+        struct iterator *res = NULL;
+        if (!it)
+                goto out;
+
+        res = par_min_max(it, COMP_TYPE_MIN);
+out:
+        it_unref(it);
+        return res;
+}
+
+struct iterator *ctn_par_max(struct iterator *it)
+{
+        struct iterator *res = NULL;
+        if (!it)
+                goto out;
+
+        res = par_min_max(it, COMP_TYPE_MAX);
+out:
+        it_unref(it);
+        return res;
+}
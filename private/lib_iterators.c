@@ -106,3 +106,50 @@ int it_copy(struct iterator *dest, const struct iterator *src)
 
         return dest->cbs->copy_cb(dest, src);
 }
+
+ssize_t it_span(const struct iterator *it, void **data)
+{
+        if (!it || !data)
+                return -EINVAL;
+
+        if (!it->cbs->span_cb)
+                return -ENOTSUP;
+
+        return it->cbs->span_cb(it, data);
+}
+
+int it_advance(struct iterator *it, ssize_t offset)
+{
+        if (!it)
+                return -EINVAL;
+
+        if (it->cbs->advance_cb)
+                return it->cbs->advance_cb(it, offset);
+
+        for (; offset > 0; --offset)
+                it->cbs->next_cb(it);
+
+        for (; offset < 0; ++offset)
+                it->cbs->previous_cb(it);
+
+        return 0;
+}
+
+bool it_can_overwrite(const struct iterator *it)
+{
+        return (it && !it->cbs->intrusive);
+}
+
+bool it_can_slice(const struct iterator *it)
+{
+        return (it && it->cbs->slice_cb);
+}
+
+struct iterator *it_slice(
+                const struct iterator *it, size_t index, size_t count)
+{
+        if (!it_can_slice(it) || index >= count)
+                return NULL;
+
+        return it->cbs->slice_cb(it, index, count);
+}
@@ -11,6 +11,7 @@
 #include "lib_iterators.h"
 
 #include <stdatomic.h>
+#include <sys/types.h>
 
 /* Definitions ---------------------------------------------------------------*/
 
@@ -23,6 +24,10 @@ typedef int (*it_remove_cb)(struct iterator *);
 typedef struct iterator *(*it_dup_cb)(const struct iterator *);
 typedef int (*it_copy_cb)(struct iterator *, const struct iterator *);
 typedef void (*it_destroy_cb)(const struct iterator *);
+typedef ssize_t (*it_span_cb)(const struct iterator *, void **);
+typedef int (*it_advance_cb)(struct iterator *, ssize_t);
+typedef struct iterator *(*it_slice_cb)(
+                const struct iterator *, size_t, size_t);
 
 struct iterator_callbacks {
         it_next_cb next_cb;
@@ -34,6 +39,10 @@ struct iterator_callbacks {
         it_dup_cb dup_cb;
         it_copy_cb copy_cb;
         it_destroy_cb destroy_cb;
+        it_span_cb span_cb; /* Optional, only for contiguous containers */
+        it_advance_cb advance_cb; /* Optional, only for random access */
+        it_slice_cb slice_cb; /* Optional, only for splittable containers */
+        bool intrusive; /* Elements embed their links, never copied into */
 };
 
 struct iterator {
@@ -48,4 +57,57 @@ struct iterator {
  */
 void it_init(struct iterator *it, const struct iterator_callbacks *cbs);
 
+/**
+ * @brief Gives access to the elements stored contiguously in memory from the
+ * value pointed by 'it' to the last one in iteration order. 'data' is set to
+ * the value pointed by 'it'.
+ *
+ * @return The number of contiguous elements on success.
+ * @return -EINVAL if 'it' or 'data' are invalid, or if 'it' points to an
+ * invalid value.
+ * @return -ENOTSUP if the elements seen by 'it' are not contiguous.
+ */
+ssize_t it_span(const struct iterator *it, void **data);
+
+/**
+ * @brief Moves 'it' of 'offset' elements, forward if 'offset' is positive and
+ * backward otherwise. Random access iterators do it in constant time.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'it' is invalid.
+ */
+int it_advance(struct iterator *it, ssize_t offset);
+
+/**
+ * @brief Indicates if the elements seen by 'it' can be overwritten by copying
+ * values into them. Objects of intrusive lists can not, as a copy would replace
+ * the link they embed.
+ *
+ * @return true if the elements of 'it' can be overwritten.
+ * @return false otherwise or if 'it' is invalid.
+ */
+bool it_can_overwrite(const struct iterator *it);
+
+/**
+ * @brief Indicates if the elements starting from 'it' can be split in slices
+ * with it_slice().
+ *
+ * @return true if 'it' can be sliced.
+ * @return false otherwise or if 'it' is invalid.
+ */
+bool it_can_slice(const struct iterator *it);
+
+/**
+ * @brief Splits the elements starting from 'it' into 'count' disjoint slices
+ * and creates an iterator over the 'index'th one. The created iterator becomes
+ * invalid when moving past the end of its slice, it is already invalid if the
+ * slice is empty. Slices are ordered following the iteration order of 'it'.
+ *
+ * @return Pointer to the iterator on success.
+ * @return NULL if 'it' can not be sliced, if 'index' is not lower than 'count'
+ * or on failure.
+ */
+struct iterator *it_slice(
+                const struct iterator *it, size_t index, size_t count);
+
 #endif /* LIB_ITERATORS_PRIVATE_H */
@@ -5,31 +5,58 @@
 
 /* Includes ------------------------------------------------------------------*/
 
+#include "lib_allocators_private.h"
 #include "lib_iterators_private.h"
 #include "lib_lists.h"
+#include "lib_slabs.h"
 
 #include <errno.h>
+#include <stdalign.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stddef.h>
-#include <stdlib.h>
 
 /* Definitions ---------------------------------------------------------------*/
 
+/*
+ * Nodes are allocated along with their element in a single object :
+ * | struct node | element |
+ */
 struct node {
         struct list *head;
-        void *data;
+        struct node_pool *pool; /* Allocated from, kept when moved */
         struct node *next;
         struct node *previous;
 };
 
+/* Offset of the element from the start of its node */
+#define NODE_DATA_OFFSET \
+        ((sizeof(struct node) + alignof(max_align_t) - 1) \
+                        / alignof(max_align_t) * alignof(max_align_t))
+
+/*
+ * Each list allocates its nodes from its own pool. Nodes moved to another list
+ * keep their pool, and are given back to it through the remote free list of
+ * its slabs, so that lists stay independent and may be used from different
+ * threads. The pool outlives its list as long as such nodes remain.
+ */
+struct node_pool {
+        struct slab_pool slabs; /* Nodes along with their element */
+        atomic_size_t refs; /* Its list, plus its nodes inside other lists */
+};
+
 struct list {
+        const struct allocator *allocator;
         const struct type_info *type;
         size_t len;
+        size_t foreign; /* Nodes allocated from the pool of another list */
+        struct node_pool *pool;
         struct node base_node; /* Useful for functions simplifications */
 };
 
 struct list_it {
         struct iterator it; /* Placed at top for inheritance */
+        const struct allocator *allocator; /* May outlive 'list' */
         const struct list *list;
         struct node *node;
 };
@@ -38,6 +65,51 @@ struct list_it {
 
 /* Private utility functions ---------*/
 
+static void *element(const struct node *node)
+{
+        return (char *)node + NODE_DATA_OFFSET;
+}
+
+static struct node_pool *create_pool(
+                const struct type_info *type,
+                const struct allocator *allocator)
+{
+        struct node_pool *pool = allocator_calloc(allocator, sizeof(*pool));
+        if (!pool)
+                return NULL;
+
+        slab_pool_init(&pool->slabs, NODE_DATA_OFFSET + type->size, allocator);
+        atomic_init(&pool->refs, 1);
+
+        return pool;
+}
+
+/**
+ * @brief Drops 'count' references on 'pool', destroying it along with all its
+ * slabs once no reference remains.
+ */
+static void unref_pool(struct node_pool *pool, size_t count)
+{
+        if (atomic_fetch_sub_explicit(&pool->refs, count,
+                        memory_order_acq_rel) != count)
+                return;
+
+        const struct allocator *allocator = pool->slabs.allocator;
+        slab_pool_release(&pool->slabs);
+        allocator_free(allocator, pool, sizeof(*pool));
+}
+
+/**
+ * @brief Indicates if every node allocated from the pool of 'list' is inside
+ * 'list', and every node of 'list' is allocated from its pool.
+ */
+static bool owns_nodes(const struct list *list)
+{
+        return (list->foreign == 0
+                        && atomic_load_explicit(&list->pool->refs,
+                                        memory_order_acquire) == 1);
+}
+
 /**
  * @brief Inserts an empty node of 'list' before 'next' containing 'value'.
  *
@@ -47,17 +119,12 @@ struct list_it {
 static struct node *insert_node(
                 struct list *list, struct node *next, const void *value)
 {
-        struct node *node = calloc(1, sizeof(*node));
+        struct node *node = slab_alloc(&list->pool->slabs);
         if (!node)
                 return NULL;
 
-        node->data = calloc(1, list->type->size);
-        if (!node->data) {
-                free(node);
-                return NULL;
-        }
-
         node->head = list;
+        node->pool = list->pool;
 
         node->next = next;
         node->previous = next->previous;
@@ -65,7 +132,7 @@ static struct node *insert_node(
         node->next->previous = node;
         node->previous->next = node;
 
-        list->type->copy(node->data, value);
+        list->type->copy(element(node), value);
         ++list->len;
 
         return node;
@@ -73,9 +140,20 @@ static struct node *insert_node(
 
 static void destroy_node(const struct node *node)
 {
-        node->head->type->destroy(node->data);
-        free(node->data);
-        free((struct node *)node);
+        struct list *list = node->head;
+        struct node_pool *pool = node->pool;
+
+        list->type->destroy(element(node));
+
+        if (pool == list->pool) {
+                slab_free(&pool->slabs, (struct node *)node);
+                return;
+        }
+
+        /* The list owning 'pool' may be used by another thread */
+        --list->foreign;
+        slab_free_remote(&pool->slabs, (struct node *)node);
+        unref_pool(pool, 1);
 }
 
 static void remove_node(const struct node *node)
@@ -89,12 +167,176 @@ static void remove_node(const struct node *node)
         destroy_node(node);
 }
 
+/**
+ * @brief Moves the nodes from 'first' to 'last' included before 'pos' inside
+ * 'dest', and makes them belong to it. Nodes leaving the list of their pool
+ * hold a reference on it, nodes coming back to it drop theirs.
+ */
+static void move_nodes(
+                struct list *dest,
+                struct node *pos,
+                struct node *first,
+                struct node *last)
+{
+        struct list *src = first->head;
+
+        first->previous->next = last->next;
+        last->next->previous = first->previous;
+
+        first->previous = pos->previous;
+        last->next = pos;
+        pos->previous->next = first;
+        pos->previous = last;
+
+        if (src == dest)
+                return;
+
+        size_t count = 0;
+        size_t leaving = 0;
+        size_t returning = 0;
+
+        for (struct node *node = first;; node = node->next) {
+                node->head = dest;
+                ++count;
+
+                if (node->pool == src->pool)
+                        ++leaving;
+                else if (node->pool == dest->pool)
+                        ++returning;
+
+                if (node == last)
+                        break;
+        }
+
+        src->len -= count;
+        src->foreign -= count - leaving;
+        dest->len += count;
+        dest->foreign += count - returning;
+
+        if (leaving > 0)
+                atomic_fetch_add_explicit(&src->pool->refs, leaving,
+                                memory_order_relaxed);
+
+        /* 'dest' still holds a reference on its own pool */
+        if (returning > 0)
+                unref_pool(dest->pool, returning);
+}
+
+/**
+ * @brief Sorts the nodes of 'list' following 'comp' by a bottom-up merge sort,
+ * relinking them in place. Runs of doubling width are merged while following
+ * 'next' pointers only, 'previous' ones are restored at the end.
+ */
+static void sort_nodes(struct list *list, type_comp_cb comp)
+{
+        if (list->len < 2)
+                return;
+
+        struct node *head = list->base_node.next;
+        list->base_node.previous->next = NULL;
+
+        for (size_t width = 1;; width *= 2) {
+                struct node *p = head;
+                struct node **tail = &head;
+                size_t merges = 0;
+
+                while (p) {
+                        struct node *q = p;
+                        size_t p_len = 0;
+                        size_t q_len = width;
+
+                        for (; p_len < width && q; ++p_len)
+                                q = q->next;
+
+                        while (p_len > 0 || (q_len > 0 && q)) {
+                                struct node *node;
+
+                                /* Equal elements are taken from 'p' first */
+                                if (p_len > 0 && (q_len == 0 || !q
+                                                || comp(element(p),
+                                                        element(q)) <= 0)) {
+                                        node = p;
+                                        p = p->next;
+                                        --p_len;
+                                } else {
+                                        node = q;
+                                        q = q->next;
+                                        --q_len;
+                                }
+
+                                *tail = node;
+                                tail = &node->next;
+                        }
+
+                        p = q;
+                        ++merges;
+                }
+
+                *tail = NULL;
+                if (merges <= 1)
+                        break;
+        }
+
+        struct node *previous = &list->base_node;
+        for (struct node *node = head; node; node = node->next) {
+                node->previous = previous;
+                previous->next = node;
+                previous = node;
+        }
+
+        previous->next = &list->base_node;
+        list->base_node.previous = previous;
+}
+
+/**
+ * @brief Moves the nodes of the sorted 'src' inside the sorted 'dest' so that
+ * it stays sorted following 'comp'. Runs of consecutive nodes of 'src' are
+ * moved at once.
+ */
+static void merge_nodes(struct list *dest, struct list *src, type_comp_cb comp)
+{
+        struct node *pos = dest->base_node.next;
+
+        while (src->len > 0) {
+                struct node *first = src->base_node.next;
+
+                /* Equal elements of 'dest' stay before the ones of 'src' */
+                while (pos != &dest->base_node
+                                && comp(element(pos), element(first)) <= 0)
+                        pos = pos->next;
+
+                struct node *last = src->base_node.previous;
+                if (pos != &dest->base_node) {
+                        last = first;
+                        while (last->next != &src->base_node
+                                        && comp(element(last->next),
+                                                element(pos)) < 0)
+                                last = last->next;
+                }
+
+                move_nodes(dest, pos, first, last);
+        }
+}
+
+/**
+ * @brief Destroys every element of 'list'. If all the nodes of its pool are
+ * inside it, they are released at once by releasing their slabs.
+ */
 static void clear_list(struct list *list)
 {
-        struct node *next = list->base_node.next;
-        for (struct node *node = next; node != &list->base_node; node = next) {
-                next = node->next;
-                destroy_node(node);
+        struct node *node = list->base_node.next;
+
+        if (owns_nodes(list)) {
+                for (; node != &list->base_node; node = node->next)
+                        list->type->destroy(element(node));
+
+                slab_pool_release(&list->pool->slabs);
+        } else {
+                while (node != &list->base_node) {
+                        struct node *next = node->next;
+                        destroy_node(node);
+                        node = next;
+                }
         }
 
         list->len = 0;
@@ -102,27 +344,55 @@ static void clear_list(struct list *list)
         list->base_node.previous = &list->base_node;
 }
 
+static struct list *create_list(
+                const struct type_info *type,
+                const struct allocator *allocator)
+{
+        struct list *list = allocator_calloc(allocator, sizeof(*list));
+        if (!list)
+                return NULL;
+
+        list->allocator = allocator;
+        list->type = type;
+        list->len = 0;
+        list->foreign = 0;
+        list->base_node.head = list;
+        list->base_node.next = &list->base_node;
+        list->base_node.previous = &list->base_node;
+
+        return list;
+}
+
 /* API -----------------------------------------------------------------------*/
 
 struct list *list_create(const struct type_info *type)
 {
-        if (!type)
+        return list_create_with(type, allocator_default());
+}
+
+struct list *list_create_with(
+                const struct type_info *type,
+                const struct allocator *allocator)
+{
+        if (!type || !allocator_is_valid(allocator))
                 return NULL;
 
         if (type->size == 0 || !type->copy || !type->destroy)
                 return NULL;
 
-        struct list *list = calloc(1, sizeof(*list));
+        struct list *list = create_list(type, allocator);
         if (!list)
                 return NULL;
 
-        list->type = type;
-        list->len = 0;
-        list->base_node.head = list;
-        list->base_node.next = &list->base_node;
-        list->base_node.previous = &list->base_node;
+        list->pool = create_pool(type, allocator);
+        if (!list->pool)
+                goto error_pool;
 
         return list;
+
+error_pool:
+        allocator_free(allocator, list, sizeof(*list));
+        return NULL;
 }
 
 void list_destroy(const struct list *list)
@@ -131,7 +401,8 @@ void list_destroy(const struct list *list)
                 return;
 
         clear_list((struct list *)list);
-        free((struct list *)list);
+        unref_pool(list->pool, 1);
+        allocator_free(list->allocator, (struct list *)list, sizeof(*list));
 }
 
 struct node *list_push_front(struct list *list, const void *value)
@@ -186,6 +457,96 @@ int list_remove(struct list *list, const struct node *node)
         return 0;
 }
 
+int list_splice(
+                struct list *dest,
+                struct node *pos,
+                struct list *src,
+                struct node *first,
+                struct node *last)
+{
+        if (!dest || !src || !first || !last)
+                return -EINVAL;
+
+        if (dest->type != src->type || dest->allocator != src->allocator)
+                return -EINVAL;
+
+        if (first->head != src || first == &src->base_node)
+                return -EINVAL;
+
+        if (last->head != src || last == &src->base_node)
+                return -EINVAL;
+
+        if (!pos)
+                pos = &dest->base_node;
+        else if (pos->head != dest)
+                return -EINVAL;
+
+        move_nodes(dest, pos, first, last);
+
+        return 0;
+}
+
+int list_concat(struct list *dest, struct list *src)
+{
+        if (!dest || !src || dest == src)
+                return -EINVAL;
+
+        if (dest->type != src->type || dest->allocator != src->allocator)
+                return -EINVAL;
+
+        if (src->len == 0)
+                return 0;
+
+        move_nodes(dest, &dest->base_node, src->base_node.next,
+                        src->base_node.previous);
+
+        return 0;
+}
+
+struct list *list_split_at(struct list *list, struct node *node)
+{
+        if (!list || !node || node->head != list || node == &list->base_node)
+                return NULL;
+
+        struct list *tail = list_create_with(list->type, list->allocator);
+        if (!tail)
+                return NULL;
+
+        move_nodes(tail, &tail->base_node, node, list->base_node.previous);
+
+        return tail;
+}
+
+int list_sort(struct list *list)
+{
+        if (!list)
+                return -EINVAL;
+
+        return list_sort_by(list, list->type->comp);
+}
+
+int list_sort_by(struct list *list, type_comp_cb comp)
+{
+        if (!list || !comp)
+                return -EINVAL;
+
+        sort_nodes(list, comp);
+        return 0;
+}
+
+int list_merge(struct list *dest, struct list *src)
+{
+        if (!dest || !src || dest == src || !dest->type->comp)
+                return -EINVAL;
+
+        if (dest->type != src->type || dest->allocator != src->allocator)
+                return -EINVAL;
+
+        merge_nodes(dest, src, dest->type->comp);
+
+        return 0;
+}
+
 int list_clear(struct list *list)
 {
         if (!list)
@@ -257,7 +618,7 @@ void *node_data(struct node *node)
         if (!node || node == &node->head->base_node)
                 return NULL;
 
-        return node->data;
+        return element(node);
 }
 
 /* Iterator API --------------------------------------------------------------*/
@@ -272,11 +633,12 @@ static struct list_it *list_it_create(
                 struct node *node,
                 const struct iterator_callbacks *cbs)
 {
-        struct list_it *l_it = calloc(1, sizeof(*l_it));
+        struct list_it *l_it = allocator_calloc(list->allocator, sizeof(*l_it));
         if (!l_it)
                 return NULL;
 
         it_init(&l_it->it, &list_it_cbs);
+        l_it->allocator = list->allocator;
         l_it->list = list;
         l_it->node = node;
         l_it->it.cbs = cbs;
@@ -312,7 +674,7 @@ static void *list_it_data(const struct iterator *it)
                 return NULL;
 
         const struct list_it *l_it = (const struct list_it *)it;
-        return l_it->node->data;
+        return element(l_it->node);
 }
 
 static const struct type_info *list_it_type(const struct iterator *it)
@@ -378,7 +740,7 @@ static int list_it_copy(struct iterator *dest, const struct iterator *src)
 static void list_it_destroy(const struct iterator *it)
 {
         struct list_it *l_it = (struct list_it *)it;
-        free(l_it);
+        allocator_free(l_it->allocator, l_it, sizeof(*l_it));
 }
 
 static struct iterator_callbacks list_it_cbs = {
@@ -458,3 +820,376 @@ struct iterator *list_rend(const struct list *list)
 
         return (struct iterator *)l_it;
 }
+
+/* Intrusive list API --------------------------------------------------------*/
+
+struct ilist {
+        const struct allocator *allocator;
+        const struct type_info *type;
+        size_t offset; /* Of the links inside the objects */
+        size_t len;
+        struct list_link base_link; /* Useful for functions simplifications */
+};
+
+struct ilist_it {
+        struct iterator it; /* Placed at top for inheritance */
+        const struct allocator *allocator; /* May outlive 'ilist' */
+        const struct ilist *ilist;
+        struct list_link *link;
+};
+
+static struct iterator_callbacks ilist_it_cbs;
+static struct iterator_callbacks ilist_rit_cbs;
+
+/* Utility functions -----------------*/
+
+static void insert_link(
+                struct ilist *ilist,
+                struct list_link *next,
+                struct list_link *link)
+{
+        link->next = next;
+        link->previous = next->previous;
+
+        link->next->previous = link;
+        link->previous->next = link;
+
+        ++ilist->len;
+}
+
+static void remove_link(struct ilist *ilist, struct list_link *link)
+{
+        link->next->previous = link->previous;
+        link->previous->next = link->next;
+
+        link->next = NULL;
+        link->previous = NULL;
+
+        --ilist->len;
+}
+
+static struct ilist_it *ilist_it_create(
+                const struct ilist *ilist,
+                struct list_link *link,
+                const struct iterator_callbacks *cbs)
+{
+        struct ilist_it *i_it =
+                        allocator_calloc(ilist->allocator, sizeof(*i_it));
+        if (!i_it)
+                return NULL;
+
+        it_init(&i_it->it, cbs);
+        i_it->allocator = ilist->allocator;
+        i_it->ilist = ilist;
+        i_it->link = link;
+
+        return i_it;
+}
+
+/* Iterator implementation -----------*/
+
+static int ilist_it_next(struct iterator *it)
+{
+        struct ilist_it *i_it = (struct ilist_it *)it;
+        i_it->link = i_it->link->next;
+        return 0;
+}
+
+static int ilist_it_previous(struct iterator *it)
+{
+        struct ilist_it *i_it = (struct ilist_it *)it;
+        i_it->link = i_it->link->previous;
+        return 0;
+}
+
+static bool ilist_it_is_valid(const struct iterator *it)
+{
+        const struct ilist_it *i_it = (const struct ilist_it *)it;
+        return (i_it->link != &i_it->ilist->base_link);
+}
+
+static void *ilist_it_data(const struct iterator *it)
+{
+        if (!ilist_it_is_valid(it))
+                return NULL;
+
+        const struct ilist_it *i_it = (const struct ilist_it *)it;
+        return (char *)i_it->link - i_it->ilist->offset;
+}
+
+static const struct type_info *ilist_it_type(const struct iterator *it)
+{
+        const struct ilist_it *i_it = (const struct ilist_it *)it;
+        return i_it->ilist->type;
+}
+
+static int ilist_it_remove(struct iterator *it)
+{
+        if (!ilist_it_is_valid(it))
+                return -EINVAL;
+
+        struct ilist_it *i_it = (struct ilist_it *)it;
+        struct list_link *next = i_it->link->next;
+
+        remove_link((struct ilist *)i_it->ilist, i_it->link);
+        i_it->link = next;
+
+        return 0;
+}
+
+static int ilist_rit_remove(struct iterator *it)
+{
+        if (!ilist_it_is_valid(it))
+                return -EINVAL;
+
+        struct ilist_it *i_it = (struct ilist_it *)it;
+        struct list_link *next = i_it->link->previous;
+
+        remove_link((struct ilist *)i_it->ilist, i_it->link);
+        i_it->link = next;
+
+        return 0;
+}
+
+static struct iterator *ilist_it_dup(const struct iterator *it)
+{
+        if (!ilist_it_is_valid(it))
+                return NULL;
+
+        const struct ilist_it *i_it = (const struct ilist_it *)it;
+        struct ilist_it *dup =
+                        ilist_it_create(i_it->ilist, i_it->link, i_it->it.cbs);
+        return (struct iterator *)dup;
+}
+
+static int ilist_it_copy(struct iterator *dest, const struct iterator *src)
+{
+        if (!ilist_it_is_valid(dest) || !ilist_it_is_valid(src))
+                return -EINVAL;
+
+        struct ilist_it *i_dest = (struct ilist_it *)dest;
+        const struct ilist_it *i_src = (const struct ilist_it *)src;
+
+        if (i_dest->ilist != i_src->ilist)
+                return -EINVAL;
+
+        i_dest->link = i_src->link;
+        return 0;
+}
+
+static void ilist_it_destroy(const struct iterator *it)
+{
+        struct ilist_it *i_it = (struct ilist_it *)it;
+        allocator_free(i_it->allocator, i_it, sizeof(*i_it));
+}
+
+static struct iterator_callbacks ilist_it_cbs = {
+        .next_cb = ilist_it_next,
+        .previous_cb = ilist_it_previous,
+        .is_valid_cb = ilist_it_is_valid,
+        .data_cb = ilist_it_data,
+        .type_cb = ilist_it_type,
+        .remove_cb = ilist_it_remove,
+        .dup_cb = ilist_it_dup,
+        .copy_cb = ilist_it_copy,
+        .destroy_cb = ilist_it_destroy,
+        .intrusive = true
+};
+
+static struct iterator_callbacks ilist_rit_cbs = {
+        .next_cb = ilist_it_previous,
+        .previous_cb = ilist_it_next,
+        .is_valid_cb = ilist_it_is_valid,
+        .data_cb = ilist_it_data,
+        .type_cb = ilist_it_type,
+        .remove_cb = ilist_rit_remove,
+        .dup_cb = ilist_it_dup,
+        .copy_cb = ilist_it_copy,
+        .destroy_cb = ilist_it_destroy,
+        .intrusive = true
+};
+
+/* Public API ------------------------*/
+
+struct ilist *ilist_create(const struct type_info *type, size_t offset)
+{
+        return ilist_create_with(type, offset, allocator_default());
+}
+
+struct ilist *ilist_create_with(
+                const struct type_info *type,
+                size_t offset,
+                const struct allocator *allocator)
+{
+        if (!type || !allocator_is_valid(allocator))
+                return NULL;
+
+        if (type->size < sizeof(struct list_link)
+                        || offset > type->size - sizeof(struct list_link))
+                return NULL;
+
+        struct ilist *ilist = allocator_calloc(allocator, sizeof(*ilist));
+        if (!ilist)
+                return NULL;
+
+        ilist->allocator = allocator;
+        ilist->type = type;
+        ilist->offset = offset;
+        ilist->len = 0;
+        ilist->base_link.next = &ilist->base_link;
+        ilist->base_link.previous = &ilist->base_link;
+
+        return ilist;
+}
+
+void ilist_destroy(const struct ilist *ilist)
+{
+        if (!ilist)
+                return;
+
+        /* Objects outlive 'ilist', their links must not point inside it */
+        ilist_clear((struct ilist *)ilist);
+        allocator_free(ilist->allocator, (struct ilist *)ilist,
+                        sizeof(*ilist));
+}
+
+int ilist_push_front(struct ilist *ilist, struct list_link *link)
+{
+        if (!ilist || !link)
+                return -EINVAL;
+
+        if (link->next)
+                return -EBUSY;
+
+        insert_link(ilist, ilist->base_link.next, link);
+        return 0;
+}
+
+int ilist_push_back(struct ilist *ilist, struct list_link *link)
+{
+        if (!ilist || !link)
+                return -EINVAL;
+
+        if (link->next)
+                return -EBUSY;
+
+        insert_link(ilist, &ilist->base_link, link);
+        return 0;
+}
+
+int ilist_insert(
+                struct ilist *ilist,
+                struct list_link *pos,
+                struct list_link *link)
+{
+        if (!ilist || !pos || !link || !pos->next)
+                return -EINVAL;
+
+        if (link->next)
+                return -EBUSY;
+
+        insert_link(ilist, pos, link);
+        return 0;
+}
+
+int ilist_remove(struct ilist *ilist, struct list_link *link)
+{
+        if (!ilist || !link || !link->next || link == &ilist->base_link)
+                return -EINVAL;
+
+        remove_link(ilist, link);
+        return 0;
+}
+
+int ilist_clear(struct ilist *ilist)
+{
+        if (!ilist)
+                return -EINVAL;
+
+        while (ilist->base_link.next != &ilist->base_link)
+                remove_link(ilist, ilist->base_link.next);
+
+        return 0;
+}
+
+ssize_t ilist_len(const struct ilist *ilist)
+{
+        if (!ilist)
+                return -EINVAL;
+
+        return (ssize_t)ilist->len;
+}
+
+struct list_link *ilist_first(const struct ilist *ilist)
+{
+        if (!ilist || ilist->len == 0)
+                return NULL;
+
+        return ilist->base_link.next;
+}
+
+struct list_link *ilist_last(const struct ilist *ilist)
+{
+        if (!ilist || ilist->len == 0)
+                return NULL;
+
+        return ilist->base_link.previous;
+}
+
+struct list_link *ilist_next(
+                const struct ilist *ilist, const struct list_link *link)
+{
+        if (!ilist || !link || link->next == &ilist->base_link)
+                return NULL;
+
+        return link->next;
+}
+
+struct list_link *ilist_previous(
+                const struct ilist *ilist, const struct list_link *link)
+{
+        if (!ilist || !link || link->previous == &ilist->base_link)
+                return NULL;
+
+        return link->previous;
+}
+
+struct iterator *ilist_begin(const struct ilist *ilist)
+{
+        if (!ilist)
+                return NULL;
+
+        struct ilist_it *i_it = ilist_it_create(
+                        ilist, ilist->base_link.next, &ilist_it_cbs);
+        return (struct iterator *)i_it;
+}
+
+struct iterator *ilist_end(const struct ilist *ilist)
+{
+        if (!ilist)
+                return NULL;
+
+        struct ilist_it *i_it = ilist_it_create(
+                        ilist, ilist->base_link.previous, &ilist_it_cbs);
+        return (struct iterator *)i_it;
+}
+
+struct iterator *ilist_rbegin(const struct ilist *ilist)
+{
+        if (!ilist)
+                return NULL;
+
+        struct ilist_it *i_it = ilist_it_create(
+                        ilist, ilist->base_link.previous, &ilist_rit_cbs);
+        return (struct iterator *)i_it;
+}
+
+struct iterator *ilist_rend(const struct ilist *ilist)
+{
+        if (!ilist)
+                return NULL;
+
+        struct ilist_it *i_it = ilist_it_create(
+                        ilist, ilist->base_link.next, &ilist_rit_cbs);
+        return (struct iterator *)i_it;
+}
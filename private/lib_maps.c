@@ -5,18 +5,24 @@
 
 /* Includes ------------------------------------------------------------------*/
 
+#include "lib_allocators_private.h"
 #include "lib_iterators_private.h"
 #include "lib_maps.h"
+#include "lib_slabs.h"
 
 #include <errno.h>
+#include <stdalign.h>
 #include <stddef.h>
-#include <stdlib.h>
 #include <string.h>
 
 /* Definitions ---------------------------------------------------------------*/
 
 #define DEFAULT_BUCKET_LIST_COUNT 16
 
+#define ROUND_UP_ALIGN(size) \
+        (((size) + alignof(max_align_t) - 1) \
+                        / alignof(max_align_t) * alignof(max_align_t))
+
 struct m_pair {
         void *key;
         void *value;
@@ -29,9 +35,17 @@ struct node {
         struct node *previous;
 };
 
+/*
+ * Nodes are allocated along with their key and value in a single object of
+ * 'nodes' :
+ * | struct node | key | value |
+ */
 struct map {
+        const struct allocator *allocator;
         const struct type_info *key_type;
         const struct type_info *value_type;
+        struct slab_pool nodes;
+        size_t value_offset; /* From the start of a node */
         unsigned int count;
         struct node *bucket_list;
         size_t bucket_count;
@@ -39,8 +53,10 @@ struct map {
 
 struct map_it {
         struct iterator it; /* Placed at top for inheritance */
+        const struct allocator *allocator; /* May outlive 'map' */
         struct map *map;
         int bucket_pos;
+        int bucket_end; /* Exclusive, -1 when the iterator is not a slice */
         struct node *node;
 };
 
@@ -49,58 +65,43 @@ struct map_it {
 /* Node API --------------------------*/
 
 static struct node *create_node(
-                const void *key,
-                const void *value,
-                const struct type_info *key_type,
-                const struct type_info *value_type)
+                struct map *map, const void *key, const void *value)
 {
-        struct node *node = calloc(1, sizeof(*node));
+        struct node *node = slab_alloc(&map->nodes);
         if (!node)
-                goto error_alloc_node;
-
-        node->pair.key = calloc(1, key_type->size);
-        if (!node->pair.key)
-                goto error_alloc_key;
+                return NULL;
 
-        key_type->copy(node->pair.key, key);
-        node->pair.value = calloc(1, value_type->size);
-        if (!node->pair.value)
-                goto error_alloc_value;
+        node->pair.key = (char *)node + ROUND_UP_ALIGN(sizeof(*node));
+        node->pair.value = (char *)node + map->value_offset;
 
-        value_type->copy(node->pair.value, value);
-        node->hash = key_type->hash(key);
+        map->key_type->copy(node->pair.key, key);
+        map->value_type->copy(node->pair.value, value);
+        node->hash = map->key_type->hash(key);
 
         return node;
+}
 
-error_alloc_value:
-        key_type->destroy(node->pair.key);
-        free(node->pair.key);
-error_alloc_key:
-        free(node);
-error_alloc_node:
-        return NULL;
+static void destroy_values(const struct map *map, const struct node *node)
+{
+        map->key_type->destroy(node->pair.key);
+        map->value_type->destroy(node->pair.value);
 }
 
-static void destroy_node(
-                struct node *node,
-                type_destroy_cb destroy_key,
-                type_destroy_cb destroy_value)
+static void destroy_node(struct map *map, struct node *node)
 {
-        destroy_key(node->pair.key);
-        free(node->pair.key);
-        destroy_value(node->pair.value);
-        free(node->pair.value);
-        free(node);
+        destroy_values(map, node);
+        slab_free(&map->nodes, node);
 }
 
 /* Bucket API ------------------------*/
 
-static struct node *create_bucket_list(size_t count)
+static struct node *create_bucket_list(
+                const struct allocator *allocator, size_t count)
 {
         struct node *bucket_list;
         const size_t bucket_list_size = sizeof(*bucket_list) * count;
 
-        bucket_list = calloc(1, bucket_list_size);
+        bucket_list = allocator_calloc(allocator, bucket_list_size);
         if (!bucket_list)
                 return NULL;
 
@@ -112,18 +113,12 @@ static struct node *create_bucket_list(size_t count)
         return bucket_list;
 }
 
-static void destroy_bucket(
-                struct node *bucket,
-                type_destroy_cb destroy_key,
-                type_destroy_cb destroy_value)
+static void destroy_bucket(const struct map *map, const struct node *bucket)
 {
-        struct node *node = bucket->next;
+        const struct node *node = bucket->next;
 
-        while (node != bucket) {
-                struct node *next = node->next;
-                destroy_node(node, destroy_key, destroy_value);
-                node = next;
-        }
+        for (; node != bucket; node = node->next)
+                destroy_values(map, node);
 }
 
 static struct node *get_node_from_bucket(
@@ -156,21 +151,29 @@ static void add_node_to_bucket_list(
 
 /* Map API ---------------------------*/
 
-static void destroy_map_bucket_list(const struct map *map)
+static void free_bucket_list(const struct map *map)
 {
-        for (unsigned int i = 0; i < map->bucket_count; ++i) {
-                destroy_bucket(&map->bucket_list[i],
-                                map->key_type->destroy,
-                                map->value_type->destroy);
-        }
+        allocator_free(map->allocator, map->bucket_list,
+                        sizeof(*map->bucket_list) * map->bucket_count);
+}
 
-        free(map->bucket_list);
+/**
+ * @brief Destroys every pair of 'map', then releases all its nodes at once by
+ * releasing their slabs.
+ */
+static void destroy_map_bucket_list(struct map *map)
+{
+        for (unsigned int i = 0; i < map->bucket_count; ++i)
+                destroy_bucket(map, &map->bucket_list[i]);
+
+        slab_pool_release(&map->nodes);
+        free_bucket_list(map);
 }
 
 static int resize_map_bucket_list(struct map *map)
 {
         const size_t new_count = map->bucket_count * 2;
-        struct node *new_list = create_bucket_list(new_count);
+        struct node *new_list = create_bucket_list(map->allocator, new_count);
         if (!new_list)
                 return -ENOMEM;
 
@@ -186,7 +189,7 @@ static int resize_map_bucket_list(struct map *map)
                 }
         }
 
-        free(map->bucket_list);
+        free_bucket_list(map);
         map->bucket_list = new_list;
         map->bucket_count = new_count;
 
@@ -198,7 +201,7 @@ static void remove_node_from_map(struct map *map, struct node *node)
         node->previous->next = node->next;
         node->next->previous = node->previous;
 
-        destroy_node(node, map->key_type->destroy, map->value_type->destroy);
+        destroy_node(map, node);
         --map->count;
 }
 
@@ -216,6 +219,17 @@ struct map *map_create(
                 const struct type_info *key_type,
                 const struct type_info *value_type)
 {
+        return map_create_with(key_type, value_type, allocator_default());
+}
+
+struct map *map_create_with(
+                const struct type_info *key_type,
+                const struct type_info *value_type,
+                const struct allocator *allocator)
+{
+        if (!allocator_is_valid(allocator))
+                return NULL;
+
         if (!key_type || key_type->size == 0 || !key_type->copy
                         || !key_type->comp || !key_type->hash
                         || !key_type->destroy)
@@ -225,16 +239,23 @@ struct map *map_create(
                         || !value_type->destroy)
                 return NULL;
 
-        struct map *map = calloc(1, sizeof(*map));
+        struct map *map = allocator_calloc(allocator, sizeof(*map));
         if (!map)
                 return NULL;
 
-        map->bucket_list = create_bucket_list(DEFAULT_BUCKET_LIST_COUNT);
+        map->bucket_list = create_bucket_list(allocator,
+                        DEFAULT_BUCKET_LIST_COUNT);
         if (!map->bucket_list) {
-                free(map);
+                allocator_free(allocator, map, sizeof(*map));
                 return NULL;
         }
 
+        map->value_offset = ROUND_UP_ALIGN(sizeof(struct node))
+                        + ROUND_UP_ALIGN(key_type->size);
+        slab_pool_init(&map->nodes, map->value_offset + value_type->size,
+                        allocator);
+
+        map->allocator = allocator;
         map->key_type = key_type;
         map->value_type = value_type;
         map->bucket_count = DEFAULT_BUCKET_LIST_COUNT;
@@ -248,8 +269,8 @@ void map_destroy(const struct map *map)
         if (!map)
                 return;
 
-        destroy_map_bucket_list(map);
-        free((void *)map);
+        destroy_map_bucket_list((struct map *)map);
+        allocator_free(map->allocator, (void *)map, sizeof(*map));
 }
 
 int map_add(struct map *map, const void *key, const void *value)
@@ -260,15 +281,13 @@ int map_add(struct map *map, const void *key, const void *value)
         if (get_node_from_map(map, key))
                 return -EEXIST;
 
-        struct node *node = create_node(
-                        key, value, map->key_type, map->value_type);
+        struct node *node = create_node(map, key, value);
         if (!node)
                 return -ENOMEM;
 
         if (map->count >= map->bucket_count * 3 / 4) {
                 if (resize_map_bucket_list(map) < 0) {
-                        destroy_node(node, map->key_type->destroy,
-                                        map->value_type->destroy);
+                        destroy_node(map, node);
                         return -ENOMEM;
                 }
         }
@@ -315,7 +334,8 @@ int map_clear(struct map *map)
         if (!map)
                 return -EINVAL;
 
-        struct node *new_list = create_bucket_list(DEFAULT_BUCKET_LIST_COUNT);
+        struct node *new_list = create_bucket_list(map->allocator,
+                        DEFAULT_BUCKET_LIST_COUNT);
         if (!new_list)
                 return -ENOMEM;
 
@@ -339,6 +359,12 @@ static struct node *map_it_current_bucket(const struct map_it *m_it)
         return &m_it->map->bucket_list[m_it->bucket_pos];
 }
 
+static int map_it_bucket_end(const struct map_it *m_it)
+{
+        return (m_it->bucket_end < 0 ?
+                        (int)m_it->map->bucket_count : m_it->bucket_end);
+}
+
 static void map_it_seek_next(struct map_it *m_it)
 {
         while (true) {
@@ -347,7 +373,7 @@ static void map_it_seek_next(struct map_it *m_it)
                         return;
 
                 ++m_it->bucket_pos;
-                if (m_it->bucket_pos >= m_it->map->bucket_count) {
+                if (m_it->bucket_pos >= map_it_bucket_end(m_it)) {
                         m_it->node = NULL;
                         return;
                 }
@@ -378,13 +404,15 @@ static struct map_it *map_it_create(
                 int bucket_pos,
                 const struct iterator_callbacks *cbs)
 {
-        struct map_it *m_it = calloc(1, sizeof(*m_it));
+        struct map_it *m_it = allocator_calloc(map->allocator, sizeof(*m_it));
         if (!m_it)
                 return NULL;
 
         it_init(&m_it->it, &map_it_cbs);
+        m_it->allocator = map->allocator;
         m_it->map = (struct map *)map;
         m_it->bucket_pos = bucket_pos;
+        m_it->bucket_end = -1;
         m_it->it.cbs = cbs;
 
         return m_it;
@@ -479,6 +507,7 @@ static struct iterator *map_it_dup(const struct iterator *it)
         if (!dup)
                 return NULL;
 
+        dup->bucket_end = m_it->bucket_end;
         dup->node = m_it->node;
         return (struct iterator *)dup;
 }
@@ -499,10 +528,44 @@ static int map_it_copy(struct iterator *dest, const struct iterator *src)
         return 0;
 }
 
+static struct iterator *map_it_slice(
+                const struct iterator *it, size_t index, size_t count)
+{
+        if (!map_it_is_valid(it))
+                return NULL;
+
+        /*
+         * Buckets left to visit are split evenly, the first slice always holds
+         * at least the bucket 'it' is currently in.
+         */
+        const struct map_it *m_it = (const struct map_it *)it;
+        const size_t first = m_it->bucket_pos;
+        const size_t buckets = map_it_bucket_end(m_it) - first;
+        const size_t begin = (index == 0 ?
+                        first : first + 1 + (buckets - 1) * index / count);
+        const size_t end = first + 1 + (buckets - 1) * (index + 1) / count;
+
+        struct map_it *slice = map_it_create(m_it->map, begin, m_it->it.cbs);
+        if (!slice)
+                return NULL;
+
+        slice->bucket_end = end;
+        if (begin >= end) {
+                slice->node = NULL;
+        } else if (index == 0) {
+                slice->node = m_it->node;
+        } else {
+                slice->node = map_it_current_bucket(slice);
+                map_it_seek_next(slice);
+        }
+
+        return (struct iterator *)slice;
+}
+
 static void map_it_destroy(const struct iterator *it)
 {
         struct map_it *m_it = (struct map_it *)it;
-        free(m_it);
+        allocator_free(m_it->allocator, m_it, sizeof(*m_it));
 }
 
 static struct iterator_callbacks map_it_cbs = {
@@ -514,7 +577,8 @@ static struct iterator_callbacks map_it_cbs = {
         .remove_cb = map_it_remove,
         .dup_cb = map_it_dup,
         .copy_cb = map_it_copy,
-        .destroy_cb = map_it_destroy
+        .destroy_cb = map_it_destroy,
+        .slice_cb = map_it_slice
 };
 
 static struct iterator_callbacks map_rit_cbs = {
@@ -538,7 +602,8 @@ static struct iterator_callbacks map_it_pair_cbs = {
         .remove_cb = map_it_remove,
         .dup_cb = map_it_dup,
         .copy_cb = map_it_copy,
-        .destroy_cb = map_it_destroy
+        .destroy_cb = map_it_destroy,
+        .slice_cb = map_it_slice
 };
 
 static struct iterator_callbacks map_rit_pair_cbs = {
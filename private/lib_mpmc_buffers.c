@@ -0,0 +1,302 @@
+/**
+ * @author Maxence ROBIN
+ * @brief Provides lock-free multi-producer multi-consumer bounded queues
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_allocators_private.h"
+#include "lib_mpmc_buffers.h"
+#include "lib_waits.h"
+
+#include <errno.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Definitions ---------------------------------------------------------------*/
+
+#define CACHE_LINE_SIZE 64
+
+/*
+ * Slots are made of their sequence number followed by their element :
+ * | struct slot | element |
+ * The slot of index 'i' is free for the producer claiming index 'i' when its
+ * sequence is 'i', and holds a value for the consumer claiming index 'i' when
+ * its sequence is 'i' + 1. Once read, its sequence moves one lap ahead.
+ */
+struct slot {
+        atomic_size_t sequence;
+};
+
+/* Offset of the element from the start of its slot */
+#define SLOT_DATA_OFFSET \
+        ((sizeof(struct slot) + alignof(max_align_t) - 1) \
+                        / alignof(max_align_t) * alignof(max_align_t))
+
+struct mpmc_buffer {
+        /* Producers side */
+        alignas(CACHE_LINE_SIZE) atomic_size_t write;
+
+        /* Consumers side */
+        alignas(CACHE_LINE_SIZE) atomic_size_t read;
+
+        /* Waits, only written when a thread has to wait */
+        alignas(CACHE_LINE_SIZE) struct wait_event not_empty;
+        struct wait_event not_full;
+
+        /* Read-only after creation */
+        alignas(CACHE_LINE_SIZE) const struct allocator *allocator;
+        const struct type_info *type;
+        void *base; /* Start of the allocation, before alignment */
+        size_t size; /* Of the allocation */
+        size_t mask; /* Number of slots - 1 */
+        size_t slot_size;
+        char *slots;
+};
+
+/* Static functions ----------------------------------------------------------*/
+
+static struct slot *slot_at(const struct mpmc_buffer *buffer, size_t index)
+{
+        const size_t offset = (index & buffer->mask) * buffer->slot_size;
+        return (struct slot *)(buffer->slots + offset);
+}
+
+static void *slot_data(struct slot *slot)
+{
+        return (char *)slot + SLOT_DATA_OFFSET;
+}
+
+/**
+ * @brief Returns the lowest power of two greater or equal to 'count', or 0 if
+ * there is none.
+ */
+static size_t round_up_pow2(size_t count)
+{
+        size_t pow2 = 1;
+        while (pow2 < count && pow2 <= SIZE_MAX / 2)
+                pow2 *= 2;
+
+        return (pow2 >= count ? pow2 : 0);
+}
+
+static void destroy_values(const struct mpmc_buffer *buffer)
+{
+        const size_t write = atomic_load(&buffer->write);
+        for (size_t i = atomic_load(&buffer->read); i != write; ++i)
+                buffer->type->destroy(slot_data(slot_at(buffer, i)));
+}
+
+/* API -----------------------------------------------------------------------*/
+
+struct mpmc_buffer *mpmc_buffer_create(
+                const struct type_info *type, size_t count)
+{
+        return mpmc_buffer_create_with(type, count, allocator_default());
+}
+
+struct mpmc_buffer *mpmc_buffer_create_with(
+                const struct type_info *type,
+                size_t count,
+                const struct allocator *allocator)
+{
+        if (!type || count == 0 || !allocator_is_valid(allocator))
+                return NULL;
+
+        if (type->size == 0 || !type->copy || !type->destroy)
+                return NULL;
+
+        const size_t slot_size = (SLOT_DATA_OFFSET + type->size
+                        + alignof(max_align_t) - 1)
+                        / alignof(max_align_t) * alignof(max_align_t);
+
+        count = round_up_pow2(count);
+        if (count == 0 || count > (SIZE_MAX / 2) / slot_size)
+                return NULL;
+
+        /* Room to align the buffer on a cache line */
+        const size_t size = CACHE_LINE_SIZE + sizeof(struct mpmc_buffer)
+                        + count * slot_size;
+
+        void *base = allocator_calloc(allocator, size);
+        if (!base)
+                return NULL;
+
+        const uintptr_t aligned = ((uintptr_t)base + CACHE_LINE_SIZE - 1)
+                        & ~(uintptr_t)(CACHE_LINE_SIZE - 1);
+        struct mpmc_buffer *buffer = (struct mpmc_buffer *)aligned;
+
+        atomic_init(&buffer->write, 0);
+        atomic_init(&buffer->read, 0);
+        wait_event_init(&buffer->not_empty);
+        wait_event_init(&buffer->not_full);
+        buffer->allocator = allocator;
+        buffer->type = type;
+        buffer->base = base;
+        buffer->size = size;
+        buffer->mask = count - 1;
+        buffer->slot_size = slot_size;
+        buffer->slots = (char *)(buffer + 1);
+
+        for (size_t i = 0; i < count; ++i)
+                atomic_init(&slot_at(buffer, i)->sequence, i);
+
+        return buffer;
+}
+
+void mpmc_buffer_destroy(const struct mpmc_buffer *buffer)
+{
+        if (!buffer)
+                return;
+
+        destroy_values(buffer);
+        allocator_free(buffer->allocator, buffer->base, buffer->size);
+}
+
+int mpmc_buffer_try_push(struct mpmc_buffer *buffer, const void *data)
+{
+        if (!buffer || !data)
+                return -EINVAL;
+
+        size_t write = atomic_load_explicit(
+                        &buffer->write, memory_order_relaxed);
+        struct slot *slot;
+
+        while (true) {
+                slot = slot_at(buffer, write);
+
+                const size_t sequence = atomic_load_explicit(
+                                &slot->sequence, memory_order_acquire);
+                const intptr_t diff = (intptr_t)(sequence - write);
+
+                if (diff == 0) {
+                        if (atomic_compare_exchange_weak_explicit(
+                                        &buffer->write, &write, write + 1,
+                                        memory_order_relaxed,
+                                        memory_order_relaxed))
+                                break;
+                } else if (diff < 0) {
+                        /* Not yet read since the previous lap */
+                        return -ENOBUFS;
+                } else {
+                        write = atomic_load_explicit(
+                                        &buffer->write, memory_order_relaxed);
+                }
+        }
+
+        /* The slot may still hold a value moved out by a consumer */
+        memset(slot_data(slot), 0, buffer->type->size);
+        buffer->type->copy(slot_data(slot), data);
+
+        atomic_store_explicit(&slot->sequence, write + 1, memory_order_release);
+        wait_event_notify(&buffer->not_empty);
+        return 0;
+}
+
+int mpmc_buffer_try_pop(struct mpmc_buffer *buffer, void *data)
+{
+        if (!buffer || !data)
+                return -EINVAL;
+
+        size_t read = atomic_load_explicit(&buffer->read, memory_order_relaxed);
+        struct slot *slot;
+
+        while (true) {
+                slot = slot_at(buffer, read);
+
+                const size_t sequence = atomic_load_explicit(
+                                &slot->sequence, memory_order_acquire);
+                const intptr_t diff = (intptr_t)(sequence - (read + 1));
+
+                if (diff == 0) {
+                        if (atomic_compare_exchange_weak_explicit(
+                                        &buffer->read, &read, read + 1,
+                                        memory_order_relaxed,
+                                        memory_order_relaxed))
+                                break;
+                } else if (diff < 0) {
+                        /* Not yet written during this lap */
+                        return -ENOMEM;
+                } else {
+                        read = atomic_load_explicit(
+                                        &buffer->read, memory_order_relaxed);
+                }
+        }
+
+        memcpy(data, slot_data(slot), buffer->type->size);
+
+        atomic_store_explicit(&slot->sequence, read + buffer->mask + 1,
+                        memory_order_release);
+        wait_event_notify(&buffer->not_full);
+        return 0;
+}
+
+int mpmc_buffer_push_wait(
+                struct mpmc_buffer *buffer, const void *data, int timeout)
+{
+        struct timespec deadline;
+        wait_deadline(&deadline, timeout);
+
+        while (true) {
+                int ret = mpmc_buffer_try_push(buffer, data);
+                if (ret != -ENOBUFS)
+                        return ret;
+
+                const unsigned int key = wait_event_prepare(&buffer->not_full);
+
+                ret = mpmc_buffer_try_push(buffer, data);
+                if (ret != -ENOBUFS) {
+                        wait_event_cancel(&buffer->not_full);
+                        return ret;
+                }
+
+                if (wait_event_wait(&buffer->not_full, key, &deadline) < 0)
+                        return -ETIMEDOUT;
+        }
+}
+
+int mpmc_buffer_pop_wait(
+                struct mpmc_buffer *buffer, void *data, int timeout)
+{
+        struct timespec deadline;
+        wait_deadline(&deadline, timeout);
+
+        while (true) {
+                int ret = mpmc_buffer_try_pop(buffer, data);
+                if (ret != -ENOMEM)
+                        return ret;
+
+                const unsigned int key = wait_event_prepare(&buffer->not_empty);
+
+                ret = mpmc_buffer_try_pop(buffer, data);
+                if (ret != -ENOMEM) {
+                        wait_event_cancel(&buffer->not_empty);
+                        return ret;
+                }
+
+                if (wait_event_wait(&buffer->not_empty, key, &deadline) < 0)
+                        return -ETIMEDOUT;
+        }
+}
+
+ssize_t mpmc_buffer_len(const struct mpmc_buffer *buffer)
+{
+        if (!buffer)
+                return -EINVAL;
+
+        const size_t read = atomic_load(&buffer->read);
+        const size_t write = atomic_load(&buffer->write);
+
+        return (ssize_t)(write - read);
+}
+
+ssize_t mpmc_buffer_count(const struct mpmc_buffer *buffer)
+{
+        if (!buffer)
+                return -EINVAL;
+
+        return (ssize_t)(buffer->mask + 1);
+}
@@ -0,0 +1,338 @@
+/**
+ * @author Maxence ROBIN
+ * @brief Provides circular buffers of variable-length records
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_allocators_private.h"
+#include "lib_record_buffers.h"
+
+#include <errno.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Definitions ---------------------------------------------------------------*/
+
+#define CACHE_LINE_SIZE 64
+
+/* Length of the marker telling the rest of the buffer is skipped */
+#define RECORD_SKIP SIZE_MAX
+
+/*
+ * Records are made of their header followed by their bytes, padded so that
+ * the next header is aligned :
+ * | struct record | bytes | padding |
+ * A record never wraps around the end of the buffer : when it does not fit
+ * before it, a header of length RECORD_SKIP fills the end of the buffer and
+ * the record is stored at its start. Both are published at once.
+ */
+struct record {
+        size_t len;
+};
+
+/* Offset of the bytes from the start of their record */
+#define RECORD_HEADER_SIZE \
+        ((sizeof(struct record) + alignof(max_align_t) - 1) \
+                        / alignof(max_align_t) * alignof(max_align_t))
+
+#define RECORD_BUFFER_MIN_SIZE (4 * RECORD_HEADER_SIZE)
+
+/*
+ * 'read' and 'write' count every byte ever consumed and produced, the offset
+ * of a byte is its position masked by 'mask'. As in struct spsc_buffer, each
+ * side keeps the last position of the other side it has seen.
+ */
+struct record_buffer {
+        /* Consumer side */
+        alignas(CACHE_LINE_SIZE) atomic_size_t read;
+        size_t cached_write;
+
+        /* Producer side */
+        alignas(CACHE_LINE_SIZE) atomic_size_t write;
+        size_t cached_read;
+        size_t reserved; /* Length reserved, 0 if none */
+        size_t reserved_pos; /* Of the reserved record, after any skip */
+
+        /* Read-only after creation */
+        alignas(CACHE_LINE_SIZE) const struct allocator *allocator;
+        void *base; /* Start of the allocation, before alignment */
+        size_t alloc_size;
+        size_t size; /* Of the bytes */
+        size_t mask; /* Number of bytes - 1 */
+        char *bytes;
+};
+
+/* Static functions ----------------------------------------------------------*/
+
+static struct record *record_at(const struct record_buffer *buffer, size_t pos)
+{
+        return (struct record *)(buffer->bytes + (pos & buffer->mask));
+}
+
+static char *record_data(struct record *record)
+{
+        return (char *)record + RECORD_HEADER_SIZE;
+}
+
+/**
+ * @brief Returns the number of bytes taken by a record of 'len' bytes.
+ */
+static size_t record_size(size_t len)
+{
+        return RECORD_HEADER_SIZE + (len + alignof(max_align_t) - 1)
+                        / alignof(max_align_t) * alignof(max_align_t);
+}
+
+/**
+ * @brief Returns the lowest power of two greater or equal to 'size', or 0 if
+ * there is none.
+ */
+static size_t round_up_pow2(size_t size)
+{
+        size_t pow2 = 1;
+        while (pow2 < size && pow2 <= SIZE_MAX / 2)
+                pow2 *= 2;
+
+        return (pow2 >= size ? pow2 : 0);
+}
+
+static size_t max_len(const struct record_buffer *buffer)
+{
+        /* Whatever the write position, such a record fits an empty buffer */
+        return buffer->size / 2 - RECORD_HEADER_SIZE;
+}
+
+/**
+ * @brief Looks for the first record of 'buffer' from the consumer side.
+ * 'pos' is the read position, and is set to the position of the record,
+ * after the skip marker if any.
+ *
+ * @return Pointer to the record on success.
+ * @return NULL if 'buffer' is empty.
+ */
+static struct record *first_record(struct record_buffer *buffer, size_t *pos)
+{
+        if (*pos == buffer->cached_write) {
+                buffer->cached_write = atomic_load_explicit(
+                                &buffer->write, memory_order_acquire);
+                if (*pos == buffer->cached_write)
+                        return NULL;
+        }
+
+        struct record *record = record_at(buffer, *pos);
+        if (record->len == RECORD_SKIP) {
+                *pos += buffer->size - (*pos & buffer->mask);
+                record = record_at(buffer, *pos);
+        }
+
+        return record;
+}
+
+/* API -----------------------------------------------------------------------*/
+
+struct record_buffer *record_buffer_create(size_t size)
+{
+        return record_buffer_create_with(size, allocator_default());
+}
+
+struct record_buffer *record_buffer_create_with(
+                size_t size, const struct allocator *allocator)
+{
+        if (size == 0 || !allocator_is_valid(allocator))
+                return NULL;
+
+        if (size < RECORD_BUFFER_MIN_SIZE)
+                size = RECORD_BUFFER_MIN_SIZE;
+
+        size = round_up_pow2(size);
+        if (size == 0 || size > SIZE_MAX / 2)
+                return NULL;
+
+        /* Room to align the buffer on a cache line */
+        const size_t alloc_size = CACHE_LINE_SIZE
+                        + sizeof(struct record_buffer) + size;
+
+        void *base = allocator_calloc(allocator, alloc_size);
+        if (!base)
+                return NULL;
+
+        const uintptr_t aligned = ((uintptr_t)base + CACHE_LINE_SIZE - 1)
+                        & ~(uintptr_t)(CACHE_LINE_SIZE - 1);
+        struct record_buffer *buffer = (struct record_buffer *)aligned;
+
+        atomic_init(&buffer->read, 0);
+        atomic_init(&buffer->write, 0);
+        buffer->cached_write = 0;
+        buffer->cached_read = 0;
+        buffer->reserved = 0;
+        buffer->reserved_pos = 0;
+        buffer->allocator = allocator;
+        buffer->base = base;
+        buffer->alloc_size = alloc_size;
+        buffer->size = size;
+        buffer->mask = size - 1;
+        buffer->bytes = (char *)(buffer + 1);
+
+        return buffer;
+}
+
+void record_buffer_destroy(const struct record_buffer *buffer)
+{
+        if (!buffer)
+                return;
+
+        allocator_free(buffer->allocator, buffer->base, buffer->alloc_size);
+}
+
+void *record_buffer_reserve(struct record_buffer *buffer, size_t len)
+{
+        if (!buffer || len == 0 || len > max_len(buffer))
+                return NULL;
+
+        const size_t write = atomic_load_explicit(
+                        &buffer->write, memory_order_relaxed);
+        const size_t left = buffer->size - (write & buffer->mask);
+        const size_t size = record_size(len);
+
+        /* The end of the buffer is skipped if the record does not fit */
+        const size_t skip = (left < size ? left : 0);
+
+        if (write + skip + size - buffer->cached_read > buffer->size) {
+                buffer->cached_read = atomic_load_explicit(
+                                &buffer->read, memory_order_acquire);
+                if (write + skip + size - buffer->cached_read > buffer->size)
+                        return NULL;
+        }
+
+        buffer->reserved = len;
+        buffer->reserved_pos = write + skip;
+
+        return record_data(record_at(buffer, buffer->reserved_pos));
+}
+
+int record_buffer_commit(struct record_buffer *buffer, size_t len)
+{
+        if (!buffer || len == 0)
+                return -EINVAL;
+
+        if (len > buffer->reserved)
+                return -ENOBUFS;
+
+        const size_t write = atomic_load_explicit(
+                        &buffer->write, memory_order_relaxed);
+
+        if (buffer->reserved_pos != write)
+                record_at(buffer, write)->len = RECORD_SKIP;
+
+        record_at(buffer, buffer->reserved_pos)->len = len;
+        buffer->reserved = 0;
+
+        atomic_store_explicit(&buffer->write,
+                        buffer->reserved_pos + record_size(len),
+                        memory_order_release);
+        return 0;
+}
+
+int record_buffer_push(
+                struct record_buffer *buffer, const void *data, size_t len)
+{
+        if (!buffer || !data || len == 0 || len > max_len(buffer))
+                return -EINVAL;
+
+        void *dest = record_buffer_reserve(buffer, len);
+        if (!dest)
+                return -ENOBUFS;
+
+        memcpy(dest, data, len);
+        return record_buffer_commit(buffer, len);
+}
+
+const void *record_buffer_peek(struct record_buffer *buffer, size_t *len)
+{
+        if (!buffer || !len)
+                return NULL;
+
+        size_t pos = atomic_load_explicit(&buffer->read, memory_order_relaxed);
+
+        struct record *record = first_record(buffer, &pos);
+        if (!record)
+                return NULL;
+
+        *len = record->len;
+        return record_data(record);
+}
+
+int record_buffer_pop(struct record_buffer *buffer)
+{
+        if (!buffer)
+                return -EINVAL;
+
+        size_t pos = atomic_load_explicit(&buffer->read, memory_order_relaxed);
+
+        struct record *record = first_record(buffer, &pos);
+        if (!record)
+                return -ENOMEM;
+
+        atomic_store_explicit(&buffer->read, pos + record_size(record->len),
+                        memory_order_release);
+        return 0;
+}
+
+ssize_t record_buffer_consume(
+                struct record_buffer *buffer,
+                record_cb callback,
+                void *arg,
+                size_t n)
+{
+        if (!buffer || !callback)
+                return -EINVAL;
+
+        size_t pos = atomic_load_explicit(&buffer->read, memory_order_relaxed);
+        size_t count = 0;
+
+        for (; count < n; ++count) {
+                struct record *record = first_record(buffer, &pos);
+                if (!record)
+                        break;
+
+                callback(record_data(record), record->len, arg);
+                pos += record_size(record->len);
+        }
+
+        /* The room of all the records is given back to the producer at once */
+        if (count > 0)
+                atomic_store_explicit(&buffer->read, pos,
+                                memory_order_release);
+
+        return (ssize_t)count;
+}
+
+bool record_buffer_is_empty(const struct record_buffer *buffer)
+{
+        if (!buffer)
+                return false;
+
+        const size_t read = atomic_load(&buffer->read);
+        const size_t write = atomic_load(&buffer->write);
+
+        return (read == write);
+}
+
+ssize_t record_buffer_max_len(const struct record_buffer *buffer)
+{
+        if (!buffer)
+                return -EINVAL;
+
+        return (ssize_t)max_len(buffer);
+}
+
+ssize_t record_buffer_size(const struct record_buffer *buffer)
+{
+        if (!buffer)
+                return -EINVAL;
+
+        return (ssize_t)buffer->size;
+}
@@ -0,0 +1,70 @@
+/**
+ * @author Maxence ROBIN
+ * @brief Provides searching algorithms over sorted contiguous elements.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_searches.h"
+
+/* Static functions ----------------------------------------------------------*/
+
+/**
+ * @brief Returns the position of the first element of 'data' for which 'comp'
+ * against 'value' returns at least 'limit' : 0 for a lower bound, 1 for an
+ * upper bound.
+ *
+ * The range is halved without branching on the result of the comparison, so
+ * the loop runs exactly log2('len') times and the compiler can use a
+ * conditional move instead of a mispredicted jump. Both possible next middles
+ * are prefetched to hide cache misses on large arrays.
+ */
+static size_t bound(
+                const void *data,
+                size_t len,
+                size_t size,
+                type_comp_cb comp,
+                const void *value,
+                int limit)
+{
+        const char *base = data;
+
+        if (len == 0)
+                return 0;
+
+        while (len > 1) {
+                const size_t half = len / 2;
+
+                __builtin_prefetch(base + (len - half) / 2 * size);
+                __builtin_prefetch(base + (half + (len - half) / 2) * size);
+
+                base = (comp(base + half * size, value) < limit ?
+                                base + half * size : base);
+                len -= half;
+        }
+
+        base += (comp(base, value) < limit ? size : 0);
+        return (size_t)(base - (const char *)data) / size;
+}
+
+/* API -----------------------------------------------------------------------*/
+
+size_t search_lower_bound(
+                const void *data,
+                size_t len,
+                size_t size,
+                type_comp_cb comp,
+                const void *value)
+{
+        return bound(data, len, size, comp, value, 0);
+}
+
+size_t search_upper_bound(
+                const void *data,
+                size_t len,
+                size_t size,
+                type_comp_cb comp,
+                const void *value)
+{
+        return bound(data, len, size, comp, value, 1);
+}
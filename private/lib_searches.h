@@ -0,0 +1,45 @@
+/**
+ * @author Maxence ROBIN
+ * @brief Provides searching algorithms over sorted contiguous elements.
+ */
+
+#ifndef LIB_SEARCHES_H
+#define LIB_SEARCHES_H
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_types.h"
+
+#include <stddef.h>
+
+/* API -----------------------------------------------------------------------*/
+
+/**
+ * @brief Returns the position of the first of the 'len' elements of 'size'
+ * bytes of 'data' which is not lower than 'value' following 'comp'. 'data'
+ * MUST be sorted following 'comp'.
+ *
+ * @return The position found, 'len' if every element is lower than 'value'.
+ */
+size_t search_lower_bound(
+                const void *data,
+                size_t len,
+                size_t size,
+                type_comp_cb comp,
+                const void *value);
+
+/**
+ * @brief Returns the position of the first of the 'len' elements of 'size'
+ * bytes of 'data' which is greater than 'value' following 'comp'. 'data' MUST
+ * be sorted following 'comp'.
+ *
+ * @return The position found, 'len' if no element is greater than 'value'.
+ */
+size_t search_upper_bound(
+                const void *data,
+                size_t len,
+                size_t size,
+                type_comp_cb comp,
+                const void *value);
+
+#endif /* LIB_SEARCHES_H */
@@ -0,0 +1,349 @@
+/**
+ * @author Maxence ROBIN
+ * @brief Provides vectorized kernels over contiguous elements of built-in
+ * types.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_simd.h"
+
+#include <errno.h>
+#include <math.h>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#define SIMD_X86
+#endif
+
+/* Definitions ---------------------------------------------------------------*/
+
+struct simd_kernels {
+        size_t (*count)(const void *, size_t, const void *);
+        size_t (*find)(const void *, size_t, const void *);
+        bool (*extreme)(const void *, size_t, bool, void *);
+        void (*fill)(void *, size_t, const void *);
+};
+
+union simd_value {
+        int i;
+        float f;
+        double d;
+};
+
+#ifdef SIMD_X86
+
+#define AVX2 __attribute__((target("avx2")))
+
+/* Scalar operations -----------------*/
+
+/*
+ * The 'comp' callbacks of floating point types consider a NaN equal to any
+ * value, kernels mimic this behavior.
+ */
+#define INT_EQ(a, b) ((a) == (b))
+#define INT_NAN(a) false
+#define REAL_EQ(a, b) ((a) == (b) || (a) != (a))
+#define REAL_NAN(a) ((a) != (a))
+
+/* SSE2 operations -------------------*/
+
+static inline __m128i sse2_min_epi32(__m128i a, __m128i b)
+{
+        const __m128i mask = _mm_cmpgt_epi32(a, b);
+        return _mm_or_si128(_mm_and_si128(mask, b), _mm_andnot_si128(mask, a));
+}
+
+static inline __m128i sse2_max_epi32(__m128i a, __m128i b)
+{
+        const __m128i mask = _mm_cmpgt_epi32(a, b);
+        return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+#define SSE2_INT_VEC __m128i
+#define SSE2_INT_LANES 4
+#define SSE2_INT_SET1(v) _mm_set1_epi32(v)
+#define SSE2_INT_LOAD(p) _mm_loadu_si128((const __m128i *)(p))
+#define SSE2_INT_STORE(p, v) _mm_storeu_si128((__m128i *)(p), v)
+#define SSE2_INT_EQ(a, b) \
+        _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b)))
+#define SSE2_INT_NAN(a) 0
+#define SSE2_INT_MIN(a, b) sse2_min_epi32(a, b)
+#define SSE2_INT_MAX(a, b) sse2_max_epi32(a, b)
+
+#define SSE2_FLOAT_VEC __m128
+#define SSE2_FLOAT_LANES 4
+#define SSE2_FLOAT_SET1(v) _mm_set1_ps(v)
+#define SSE2_FLOAT_LOAD(p) _mm_loadu_ps(p)
+#define SSE2_FLOAT_STORE(p, v) _mm_storeu_ps(p, v)
+#define SSE2_FLOAT_EQ(a, b) \
+        _mm_movemask_ps(_mm_or_ps(_mm_cmpeq_ps(a, b), _mm_cmpunord_ps(a, a)))
+#define SSE2_FLOAT_NAN(a) _mm_movemask_ps(_mm_cmpunord_ps(a, a))
+#define SSE2_FLOAT_MIN(a, b) _mm_min_ps(a, b)
+#define SSE2_FLOAT_MAX(a, b) _mm_max_ps(a, b)
+
+#define SSE2_DOUBLE_VEC __m128d
+#define SSE2_DOUBLE_LANES 2
+#define SSE2_DOUBLE_SET1(v) _mm_set1_pd(v)
+#define SSE2_DOUBLE_LOAD(p) _mm_loadu_pd(p)
+#define SSE2_DOUBLE_STORE(p, v) _mm_storeu_pd(p, v)
+#define SSE2_DOUBLE_EQ(a, b) \
+        _mm_movemask_pd(_mm_or_pd(_mm_cmpeq_pd(a, b), _mm_cmpunord_pd(a, a)))
+#define SSE2_DOUBLE_NAN(a) _mm_movemask_pd(_mm_cmpunord_pd(a, a))
+#define SSE2_DOUBLE_MIN(a, b) _mm_min_pd(a, b)
+#define SSE2_DOUBLE_MAX(a, b) _mm_max_pd(a, b)
+
+/* AVX2 operations -------------------*/
+
+#define AVX2_INT_VEC __m256i
+#define AVX2_INT_LANES 8
+#define AVX2_INT_SET1(v) _mm256_set1_epi32(v)
+#define AVX2_INT_LOAD(p) _mm256_loadu_si256((const __m256i *)(p))
+#define AVX2_INT_STORE(p, v) _mm256_storeu_si256((__m256i *)(p), v)
+#define AVX2_INT_EQ(a, b) \
+        _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)))
+#define AVX2_INT_NAN(a) 0
+#define AVX2_INT_MIN(a, b) _mm256_min_epi32(a, b)
+#define AVX2_INT_MAX(a, b) _mm256_max_epi32(a, b)
+
+#define AVX2_FLOAT_VEC __m256
+#define AVX2_FLOAT_LANES 8
+#define AVX2_FLOAT_SET1(v) _mm256_set1_ps(v)
+#define AVX2_FLOAT_LOAD(p) _mm256_loadu_ps(p)
+#define AVX2_FLOAT_STORE(p, v) _mm256_storeu_ps(p, v)
+#define AVX2_FLOAT_EQ(a, b) \
+        _mm256_movemask_ps(_mm256_or_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ), \
+                        _mm256_cmp_ps(a, a, _CMP_UNORD_Q)))
+#define AVX2_FLOAT_NAN(a) _mm256_movemask_ps(_mm256_cmp_ps(a, a, _CMP_UNORD_Q))
+#define AVX2_FLOAT_MIN(a, b) _mm256_min_ps(a, b)
+#define AVX2_FLOAT_MAX(a, b) _mm256_max_ps(a, b)
+
+#define AVX2_DOUBLE_VEC __m256d
+#define AVX2_DOUBLE_LANES 4
+#define AVX2_DOUBLE_SET1(v) _mm256_set1_pd(v)
+#define AVX2_DOUBLE_LOAD(p) _mm256_loadu_pd(p)
+#define AVX2_DOUBLE_STORE(p, v) _mm256_storeu_pd(p, v)
+#define AVX2_DOUBLE_EQ(a, b) \
+        _mm256_movemask_pd(_mm256_or_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ), \
+                        _mm256_cmp_pd(a, a, _CMP_UNORD_Q)))
+#define AVX2_DOUBLE_NAN(a) _mm256_movemask_pd(_mm256_cmp_pd(a, a, _CMP_UNORD_Q))
+#define AVX2_DOUBLE_MIN(a, b) _mm256_min_pd(a, b)
+#define AVX2_DOUBLE_MAX(a, b) _mm256_max_pd(a, b)
+
+/* Kernels ---------------------------*/
+
+/*
+ * Declares the kernels of 'name' elements of C type 'ctype' using the 'ops'
+ * vector operations and the 'scalar' operations for the remaining elements.
+ */
+#define DECL_KERNELS(ops, scalar, name, ctype, attr) \
+\
+attr static size_t count_##name( \
+                const void *data, size_t len, const void *value) \
+{ \
+        const ctype *values = data; \
+        const ctype v = *((const ctype *)value); \
+        const ops##_VEC vv = ops##_SET1(v); \
+        size_t count = 0; \
+        size_t i = 0; \
+\
+        for (; i + ops##_LANES <= len; i += ops##_LANES) \
+                count += __builtin_popcount( \
+                                ops##_EQ(ops##_LOAD(values + i), vv)); \
+\
+        for (; i < len; ++i) \
+                count += scalar##_EQ(values[i], v); \
+\
+        return count; \
+} \
+\
+attr static size_t find_##name( \
+                const void *data, size_t len, const void *value) \
+{ \
+        const ctype *values = data; \
+        const ctype v = *((const ctype *)value); \
+        const ops##_VEC vv = ops##_SET1(v); \
+        size_t i = 0; \
+\
+        for (; i + ops##_LANES <= len; i += ops##_LANES) { \
+                const int mask = ops##_EQ(ops##_LOAD(values + i), vv); \
+                if (mask) \
+                        return i + __builtin_ctz(mask); \
+        } \
+\
+        for (; i < len; ++i) { \
+                if (scalar##_EQ(values[i], v)) \
+                        return i; \
+        } \
+\
+        return len; \
+} \
+\
+attr static bool extreme_##name( \
+                const void *data, size_t len, bool max, void *extreme) \
+{ \
+        const ctype *values = data; \
+        ctype best = values[0]; \
+        size_t i = 0; \
+\
+        if (len >= ops##_LANES) { \
+                ops##_VEC acc = ops##_LOAD(values); \
+                int nan = ops##_NAN(acc); \
+                ctype lanes[ops##_LANES]; \
+\
+                for (i = ops##_LANES; i + ops##_LANES <= len; \
+                                i += ops##_LANES) { \
+                        const ops##_VEC v = ops##_LOAD(values + i); \
+                        nan |= ops##_NAN(v); \
+                        acc = max ? ops##_MAX(acc, v) : ops##_MIN(acc, v); \
+                } \
+\
+                if (nan) \
+                        return false; \
+\
+                ops##_STORE(lanes, acc); \
+                for (unsigned int j = 0; j < ops##_LANES; ++j) { \
+                        if (max ? lanes[j] > best : lanes[j] < best) \
+                                best = lanes[j]; \
+                } \
+        } \
+\
+        for (; i < len; ++i) { \
+                if (scalar##_NAN(values[i])) \
+                        return false; \
+\
+                if (max ? values[i] > best : values[i] < best) \
+                        best = values[i]; \
+        } \
+\
+        *((ctype *)extreme) = best; \
+        return true; \
+} \
+\
+attr static void fill_##name(void *data, size_t len, const void *value) \
+{ \
+        ctype *values = data; \
+        const ctype v = *((const ctype *)value); \
+        const ops##_VEC vv = ops##_SET1(v); \
+        size_t i = 0; \
+\
+        for (; i + ops##_LANES <= len; i += ops##_LANES) \
+                ops##_STORE(values + i, vv); \
+\
+        for (; i < len; ++i) \
+                values[i] = v; \
+}
+
+DECL_KERNELS(SSE2_INT, INT, sse2_int, int, )
+DECL_KERNELS(SSE2_FLOAT, REAL, sse2_float, float, )
+DECL_KERNELS(SSE2_DOUBLE, REAL, sse2_double, double, )
+
+DECL_KERNELS(AVX2_INT, INT, avx2_int, int, AVX2)
+DECL_KERNELS(AVX2_FLOAT, REAL, avx2_float, float, AVX2)
+DECL_KERNELS(AVX2_DOUBLE, REAL, avx2_double, double, AVX2)
+
+#define KERNELS(name) { count_##name, find_##name, extreme_##name, fill_##name }
+
+static const struct simd_kernels sse2_kernels[SIMD_KIND_COUNT] = {
+        [SIMD_KIND_INT] = KERNELS(sse2_int),
+        [SIMD_KIND_FLOAT] = KERNELS(sse2_float),
+        [SIMD_KIND_DOUBLE] = KERNELS(sse2_double)
+};
+
+static const struct simd_kernels avx2_kernels[SIMD_KIND_COUNT] = {
+        [SIMD_KIND_INT] = KERNELS(avx2_int),
+        [SIMD_KIND_FLOAT] = KERNELS(avx2_float),
+        [SIMD_KIND_DOUBLE] = KERNELS(avx2_double)
+};
+
+/* SSE2 is part of the x86-64 baseline, AVX2 is detected at load time */
+static const struct simd_kernels *kernels = sse2_kernels;
+
+__attribute__((constructor)) static void select_kernels(void)
+{
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+                kernels = avx2_kernels;
+}
+
+#else /* SIMD_X86 */
+
+static const struct simd_kernels *kernels = NULL;
+
+#endif /* SIMD_X86 */
+
+/* Static functions ----------------------------------------------------------*/
+
+static bool is_nan(enum simd_kind kind, const void *value)
+{
+        switch (kind) {
+        case SIMD_KIND_FLOAT:
+                return isnan(*((const float *)value));
+        case SIMD_KIND_DOUBLE:
+                return isnan(*((const double *)value));
+        default:
+                return false;
+        }
+}
+
+/* API -----------------------------------------------------------------------*/
+
+enum simd_kind simd_kind(const struct type_info *type)
+{
+#ifdef SIMD_X86
+        if (type == type_int())
+                return SIMD_KIND_INT;
+
+        if (type == type_float())
+                return SIMD_KIND_FLOAT;
+
+        if (type == type_double())
+                return SIMD_KIND_DOUBLE;
+#endif
+
+        return SIMD_KIND_NONE;
+}
+
+size_t simd_count(
+                enum simd_kind kind,
+                const void *data,
+                size_t len,
+                const void *value)
+{
+        /* A NaN is equal to every value */
+        if (is_nan(kind, value))
+                return len;
+
+        return kernels[kind].count(data, len, value);
+}
+
+size_t simd_find(
+                enum simd_kind kind,
+                const void *data,
+                size_t len,
+                const void *value)
+{
+        if (is_nan(kind, value))
+                return 0;
+
+        return kernels[kind].find(data, len, value);
+}
+
+ssize_t simd_min_max(
+                enum simd_kind kind, const void *data, size_t len, bool max)
+{
+        union simd_value extreme;
+
+        if (len == 0)
+                return -EINVAL;
+
+        if (!kernels[kind].extreme(data, len, max, &extreme))
+                return -EDOM;
+
+        return (ssize_t)kernels[kind].find(data, len, &extreme);
+}
+
+void simd_fill(enum simd_kind kind, void *data, size_t len, const void *value)
+{
+        kernels[kind].fill(data, len, value);
+}
@@ -0,0 +1,87 @@
+/**
+ * @author Maxence ROBIN
+ * @brief Provides vectorized kernels over contiguous elements of built-in
+ * types.
+ */
+
+#ifndef LIB_SIMD_H
+#define LIB_SIMD_H
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_types.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+/* Definitions ---------------------------------------------------------------*/
+
+enum simd_kind {
+        SIMD_KIND_NONE,
+        SIMD_KIND_INT,
+        SIMD_KIND_FLOAT,
+        SIMD_KIND_DOUBLE,
+        SIMD_KIND_COUNT
+};
+
+/* API -----------------------------------------------------------------------*/
+
+/*
+ * Except simd_kind(), functions below MUST only be called with a 'kind' other
+ * than SIMD_KIND_NONE.
+ */
+
+/**
+ * @brief Returns the kernel kind able to handle elements of 'type'. Only the
+ * type_info returned by type_int(), type_float() and type_double() are
+ * recognized, and only on targets providing vector instructions.
+ *
+ * @return The kernel kind on success.
+ * @return SIMD_KIND_NONE if 'type' has no vectorized kernel.
+ */
+enum simd_kind simd_kind(const struct type_info *type);
+
+/**
+ * @brief Counts the 'len' elements of 'data' equal to 'value', following the
+ * semantic of the 'comp' callback of the type matching 'kind'.
+ *
+ * @return The number of equal elements.
+ */
+size_t simd_count(
+                enum simd_kind kind,
+                const void *data,
+                size_t len,
+                const void *value);
+
+/**
+ * @brief Looks for the first of the 'len' elements of 'data' equal to 'value',
+ * following the semantic of the 'comp' callback of the type matching 'kind'.
+ *
+ * @return The position of the element if found.
+ * @return 'len' if no element was found.
+ */
+size_t simd_find(
+                enum simd_kind kind,
+                const void *data,
+                size_t len,
+                const void *value);
+
+/**
+ * @brief Looks for the first lowest, or greatest if 'max' is true, of the 'len'
+ * elements of 'data'.
+ *
+ * @return The position of the element on success.
+ * @return -EINVAL if 'len' is 0.
+ * @return -EDOM if a NaN was met, in which case the caller should fallback to
+ * the 'comp' callback of the type.
+ */
+ssize_t simd_min_max(
+                enum simd_kind kind, const void *data, size_t len, bool max);
+
+/**
+ * @brief Sets the 'len' elements of 'data' to 'value'.
+ */
+void simd_fill(enum simd_kind kind, void *data, size_t len, const void *value);
+
+#endif /* LIB_SIMD_H */
@@ -0,0 +1,143 @@
+/**
+ * @author Maxence ROBIN
+ * @brief Provides pools of fixed size objects carved out of slabs.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_allocators_private.h"
+#include "lib_slabs.h"
+
+#include <errno.h>
+#include <stdalign.h>
+#include <stddef.h>
+#include <string.h>
+
+/* Definitions ---------------------------------------------------------------*/
+
+#define SLAB_ALIGNMENT alignof(max_align_t)
+#define SLAB_MIN_OBJECTS 16
+#define SLAB_MAX_OBJECTS 4096 /* Slabs double in size up to this count */
+
+struct slab {
+        struct slab *next;
+        size_t size; /* Bytes, header included */
+        size_t count; /* Objects */
+        alignas(SLAB_ALIGNMENT) char objects[];
+};
+
+/* Static functions ----------------------------------------------------------*/
+
+static size_t round_up(size_t value, size_t multiple)
+{
+        return (value + multiple - 1) / multiple * multiple;
+}
+
+/**
+ * @brief Adds a new slab to 'pool', twice as large as the previous one.
+ *
+ * @return 0 on success.
+ * @return -ENOMEM on failure.
+ */
+static int add_slab(struct slab_pool *pool)
+{
+        size_t count = SLAB_MIN_OBJECTS;
+        if (pool->slabs)
+                count = pool->slabs->count * 2;
+
+        if (count > SLAB_MAX_OBJECTS)
+                count = SLAB_MAX_OBJECTS;
+
+        const size_t size = sizeof(struct slab) + count * pool->object_size;
+        const struct allocator *allocator = pool->allocator;
+
+        struct slab *slab = allocator->alloc(size, allocator->ctx);
+        if (!slab)
+                return -ENOMEM;
+
+        slab->next = pool->slabs;
+        slab->size = size;
+        slab->count = count;
+        pool->slabs = slab;
+
+        pool->unused = slab->objects;
+        pool->unused_end = slab->objects + count * pool->object_size;
+
+        return 0;
+}
+
+/* API -----------------------------------------------------------------------*/
+
+void slab_pool_init(
+                struct slab_pool *pool,
+                size_t object_size,
+                const struct allocator *allocator)
+{
+        if (object_size < sizeof(void *))
+                object_size = sizeof(void *);
+
+        *pool = (struct slab_pool) {
+                .allocator = allocator,
+                .object_size = round_up(object_size, SLAB_ALIGNMENT)
+        };
+
+        atomic_init(&pool->remote_free_list, NULL);
+}
+
+void slab_pool_release(struct slab_pool *pool)
+{
+        struct slab *slab = pool->slabs;
+
+        while (slab) {
+                struct slab *next = slab->next;
+                allocator_free(pool->allocator, slab, slab->size);
+                slab = next;
+        }
+
+        slab_pool_init(pool, pool->object_size, pool->allocator);
+}
+
+void *slab_alloc(struct slab_pool *pool)
+{
+        void *object;
+
+        /* Objects freed remotely are all taken at once */
+        if (!pool->free_list
+                        && atomic_load_explicit(&pool->remote_free_list,
+                                        memory_order_relaxed))
+                pool->free_list = atomic_exchange_explicit(
+                                &pool->remote_free_list, NULL,
+                                memory_order_acquire);
+
+        if (pool->free_list) {
+                object = pool->free_list;
+                memcpy(&pool->free_list, object, sizeof(pool->free_list));
+        } else {
+                if (pool->unused == pool->unused_end && add_slab(pool) < 0)
+                        return NULL;
+
+                object = pool->unused;
+                pool->unused += pool->object_size;
+        }
+
+        memset(object, 0, pool->object_size);
+        return object;
+}
+
+void slab_free(struct slab_pool *pool, void *object)
+{
+        memcpy(object, &pool->free_list, sizeof(pool->free_list));
+        pool->free_list = object;
+}
+
+void slab_free_remote(struct slab_pool *pool, void *object)
+{
+        void *head = atomic_load_explicit(
+                        &pool->remote_free_list, memory_order_relaxed);
+
+        do {
+                memcpy(object, &head, sizeof(head));
+        } while (!atomic_compare_exchange_weak_explicit(
+                        &pool->remote_free_list, &head, object,
+                        memory_order_release, memory_order_relaxed));
+}
@@ -0,0 +1,76 @@
+/**
+ * @author Maxence ROBIN
+ * @brief Provides pools of fixed size objects carved out of slabs.
+ */
+
+#ifndef LIB_SLABS_H
+#define LIB_SLABS_H
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_allocators.h"
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+/* Definitions ---------------------------------------------------------------*/
+
+struct slab;
+
+/**
+ * @brief Pool of objects of 'object_size' bytes. Objects are allocated from
+ * slabs holding many of them, freed objects are kept in an intrusive free list
+ * and recycled by the next allocations. Slabs are only given back to
+ * 'allocator' when the whole pool is released.
+ *
+ * A pool is used by one thread at a time, except for slab_free_remote() which
+ * any thread may call concurrently : objects freed this way are recycled once
+ * the local free list is empty.
+ */
+struct slab_pool {
+        const struct allocator *allocator;
+        size_t object_size;
+        struct slab *slabs; /* Most recent first */
+        void *free_list;
+        _Atomic(void *) remote_free_list;
+        char *unused; /* First never allocated object of the newest slab */
+        char *unused_end;
+};
+
+/* API -----------------------------------------------------------------------*/
+
+/**
+ * @brief Initializes an empty 'pool' of objects of 'object_size' bytes whose
+ * slabs are allocated from 'allocator'. Objects are aligned as malloc() ones.
+ */
+void slab_pool_init(
+                struct slab_pool *pool,
+                size_t object_size,
+                const struct allocator *allocator);
+
+/**
+ * @brief Releases every slab of 'pool', freeing all its objects at once.
+ * 'pool' is left empty and can be used again.
+ */
+void slab_pool_release(struct slab_pool *pool);
+
+/**
+ * @brief Allocates a zeroed object from 'pool'.
+ *
+ * @return Pointer to the object on success.
+ * @return NULL on failure.
+ */
+void *slab_alloc(struct slab_pool *pool);
+
+/**
+ * @brief Gives 'object' back to 'pool', which will recycle it.
+ */
+void slab_free(struct slab_pool *pool, void *object);
+
+/**
+ * @brief Gives 'object' back to 'pool' from a thread which may not be the one
+ * using 'pool'. This is lock-free and safe against concurrent calls.
+ */
+void slab_free_remote(struct slab_pool *pool, void *object);
+
+#endif /* LIB_SLABS_H */
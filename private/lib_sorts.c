@@ -0,0 +1,942 @@
+/**
+ * @author Maxence ROBIN
+ * @brief Provides sorting algorithms over contiguous elements.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_sorts.h"
+#include "lib_threads.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Definitions ---------------------------------------------------------------*/
+
+#define SORT_RUN_LEN 16 /* Runs sorted by insertion before being merged */
+#define PAR_SORT_MIN_LEN 16384 /* Below this, sorting on one thread is faster */
+#define RADIX_SORT_MIN_LEN 64 /* Below this, histograms cost more than qsort */
+#define STRING_SORT_MIN_LEN 32 /* Below this, qsort beats caching prefixes */
+#define STRING_INSERTION_LEN 16 /* Below this, strings sort by insertion */
+#define SELECT_INSERTION_LEN 16 /* Below this, selection sorts by insertion */
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+/**
+ * @brief Part of a merge round : merges the elements from 'out_first' to
+ * 'out_last' of the output of the runs [first, middle[ and [middle, last[.
+ */
+struct merge_task {
+        size_t first;
+        size_t middle;
+        size_t last;
+        size_t out_first;
+        size_t out_last;
+};
+
+/**
+ * @brief Encoding of the elements sorted by radix. Keys of signed and floating
+ * point elements are transformed so their unsigned order matches the order of
+ * the elements.
+ */
+enum radix_key {
+        RADIX_KEY_NONE,
+        RADIX_KEY_UNSIGNED,
+        RADIX_KEY_SIGNED,
+        RADIX_KEY_FLOAT
+};
+
+/**
+ * @brief String sorted by multikey quicksort, along with the 8 bytes following
+ * the current depth, read in big endian and padded with zeros past the end of
+ * the string. Comparing prefixes compares the strings on those 8 bytes without
+ * following the pointer.
+ */
+struct string_key {
+        uint64_t prefix;
+        const char *string;
+};
+
+struct sort_job {
+        char *data;
+        char *scratch;
+        size_t len;
+        size_t size;
+        type_comp_cb comp;
+        bool stable;
+
+        size_t *bounds; /* 'runs' + 1 bounds of the sorted runs */
+        size_t runs;
+
+        const char *src;
+        char *dst;
+        struct merge_task *tasks;
+};
+
+/* Static functions ----------------------------------------------------------*/
+
+/* Sequential sort -------------------*/
+
+/**
+ * @brief Sorts 'data' by insertion, using 'tmp' to hold one element.
+ */
+static void insertion_sort(
+                char *data,
+                size_t len,
+                size_t size,
+                type_comp_cb comp,
+                char *tmp)
+{
+        for (size_t i = 1; i < len; ++i) {
+                size_t j = i;
+
+                memcpy(tmp, data + i * size, size);
+                while (j > 0 && comp(data + (j - 1) * size, tmp) > 0) {
+                        memcpy(data + j * size, data + (j - 1) * size, size);
+                        --j;
+                }
+
+                memcpy(data + j * size, tmp, size);
+        }
+}
+
+/**
+ * @brief Merges the sorted runs 'a' and 'b' into 'out'. On equality, elements
+ * of 'a' come first.
+ */
+static void merge(
+                const char *a,
+                size_t a_len,
+                const char *b,
+                size_t b_len,
+                char *out,
+                size_t size,
+                type_comp_cb comp)
+{
+        while (a_len > 0 && b_len > 0) {
+                if (comp(a, b) <= 0) {
+                        memcpy(out, a, size);
+                        a += size;
+                        --a_len;
+                } else {
+                        memcpy(out, b, size);
+                        b += size;
+                        --b_len;
+                }
+
+                out += size;
+        }
+
+        memcpy(out, a, a_len * size);
+        memcpy(out + a_len * size, b, b_len * size);
+}
+
+/**
+ * @brief Stable bottom-up merge sort of 'data', using 'scratch' which MUST
+ * hold 'len' elements.
+ */
+static void merge_sort(
+                char *data,
+                size_t len,
+                size_t size,
+                type_comp_cb comp,
+                char *scratch)
+{
+        for (size_t i = 0; i < len; i += SORT_RUN_LEN) {
+                insertion_sort(data + i * size, MIN(SORT_RUN_LEN, len - i),
+                                size, comp, scratch);
+        }
+
+        char *src = data;
+        char *dst = scratch;
+
+        for (size_t width = SORT_RUN_LEN; width < len; width *= 2) {
+                for (size_t first = 0; first < len; first += 2 * width) {
+                        const size_t middle = MIN(first + width, len);
+                        const size_t last = MIN(first + 2 * width, len);
+
+                        merge(src + first * size, middle - first,
+                                        src + middle * size, last - middle,
+                                        dst + first * size, size, comp);
+                }
+
+                char *tmp = src;
+                src = dst;
+                dst = tmp;
+        }
+
+        if (src != data)
+                memcpy(data, src, len * size);
+}
+
+/* Heap and selection ----------------*/
+
+static void swap_elements(char *a, char *b, size_t size)
+{
+        char tmp[64];
+
+        while (size > 0) {
+                const size_t len = MIN(size, sizeof(tmp));
+
+                memcpy(tmp, a, len);
+                memcpy(a, b, len);
+                memcpy(b, tmp, len);
+
+                a += len;
+                b += len;
+                size -= len;
+        }
+}
+
+/**
+ * @brief Indicates if 'a' belongs above 'b' in a heap of 'order'.
+ */
+static bool heap_above(
+                const void *a,
+                const void *b,
+                type_comp_cb comp,
+                enum heap_order order)
+{
+        const int res = comp(a, b);
+        return (order == HEAP_ORDER_MAX ? res > 0 : res < 0);
+}
+
+static void sift_down(
+                char *data,
+                size_t len,
+                size_t size,
+                type_comp_cb comp,
+                enum heap_order order,
+                size_t pos)
+{
+        size_t child;
+
+        while ((child = 2 * pos + 1) < len) {
+                if (child + 1 < len && heap_above(data + (child + 1) * size,
+                                data + child * size, comp, order))
+                        ++child;
+
+                if (!heap_above(data + child * size, data + pos * size,
+                                comp, order))
+                        return;
+
+                swap_elements(data + pos * size, data + child * size, size);
+                pos = child;
+        }
+}
+
+/**
+ * @brief Sorts 'data' by insertion, swapping elements in place.
+ */
+static void swap_insertion_sort(
+                char *data,
+                size_t len,
+                size_t size,
+                type_comp_cb comp)
+{
+        for (size_t i = 1; i < len; ++i) {
+                for (size_t j = i; j > 0; --j) {
+                        char *element = data + j * size;
+                        if (comp(element - size, element) <= 0)
+                                break;
+
+                        swap_elements(element - size, element, size);
+                }
+        }
+}
+
+/**
+ * @brief Partitions 'data' around the median of its first, middle and last
+ * elements. Equal elements may end up on both sides, which keeps partitions
+ * balanced when many elements are equal.
+ *
+ * @return The final position of the pivot.
+ */
+static size_t partition(char *data, size_t len, size_t size, type_comp_cb comp)
+{
+        char *first = data;
+        char *middle = data + len / 2 * size;
+        char *last = data + (len - 1) * size;
+
+        if (comp(middle, first) < 0)
+                swap_elements(middle, first, size);
+
+        if (comp(last, middle) < 0) {
+                swap_elements(last, middle, size);
+                if (comp(middle, first) < 0)
+                        swap_elements(middle, first, size);
+        }
+
+        swap_elements(first, middle, size);
+
+        size_t i = 1;
+        size_t j = len - 1;
+        while (true) {
+                while (i <= j && comp(data + i * size, first) < 0)
+                        ++i;
+
+                while (i <= j && comp(data + j * size, first) > 0)
+                        --j;
+
+                if (i >= j)
+                        break;
+
+                swap_elements(data + i * size, data + j * size, size);
+                ++i;
+                --j;
+        }
+
+        swap_elements(first, data + j * size, size);
+        return j;
+}
+
+/* Radix sort ------------------------*/
+
+static enum radix_key radix_key(const struct type_info *type)
+{
+        if (type == type_uint() || type == type_ulong())
+                return RADIX_KEY_UNSIGNED;
+
+        if (type == type_int() || type == type_long())
+                return RADIX_KEY_SIGNED;
+
+        if (type == type_float() || type == type_double())
+                return RADIX_KEY_FLOAT;
+
+        return RADIX_KEY_NONE;
+}
+
+/*
+ * Declares functions to transform elements into keys and back, and to sort
+ * keys of 'bits' bits with one 8 bits digit per pass. Passes where all keys
+ * share the same digit are skipped.
+ */
+#define DECL_RADIX_SORT(bits) \
+\
+static void to_keys_##bits(void *data, size_t len, enum radix_key key) \
+{ \
+        const uint##bits##_t sign = (uint##bits##_t)1 << (bits - 1); \
+        char *element = data; \
+        uint##bits##_t value; \
+\
+        for (size_t i = 0; i < len; ++i, element += sizeof(value)) { \
+                memcpy(&value, element, sizeof(value)); \
+                if (key == RADIX_KEY_SIGNED) \
+                        value ^= sign; \
+                else if (key == RADIX_KEY_FLOAT) \
+                        value = (value & sign ? ~value : value | sign); \
+\
+                memcpy(element, &value, sizeof(value)); \
+        } \
+} \
+\
+static void from_keys_##bits(void *data, size_t len, enum radix_key key) \
+{ \
+        const uint##bits##_t sign = (uint##bits##_t)1 << (bits - 1); \
+        char *element = data; \
+        uint##bits##_t value; \
+\
+        for (size_t i = 0; i < len; ++i, element += sizeof(value)) { \
+                memcpy(&value, element, sizeof(value)); \
+                if (key == RADIX_KEY_SIGNED) \
+                        value ^= sign; \
+                else if (key == RADIX_KEY_FLOAT) \
+                        value = (value & sign ? value ^ sign : ~value); \
+\
+                memcpy(element, &value, sizeof(value)); \
+        } \
+} \
+\
+static void radix_sort_##bits( \
+                uint##bits##_t *keys, uint##bits##_t *scratch, size_t len) \
+{ \
+        size_t counts[sizeof(*keys)][256] = { { 0 } }; \
+        uint##bits##_t *src = keys; \
+        uint##bits##_t *dst = scratch; \
+\
+        for (size_t i = 0; i < len; ++i) { \
+                for (unsigned int d = 0; d < sizeof(*keys); ++d) \
+                        ++counts[d][(keys[i] >> (8 * d)) & 0xff]; \
+        } \
+\
+        for (unsigned int d = 0; d < sizeof(*keys); ++d) { \
+                size_t *count = counts[d]; \
+                const unsigned int shift = 8 * d; \
+\
+                if (count[(src[0] >> shift) & 0xff] == len) \
+                        continue; \
+\
+                size_t offset = 0; \
+                for (unsigned int digit = 0; digit < 256; ++digit) { \
+                        const size_t tmp = count[digit]; \
+                        count[digit] = offset; \
+                        offset += tmp; \
+                } \
+\
+                for (size_t i = 0; i < len; ++i) \
+                        dst[count[(src[i] >> shift) & 0xff]++] = src[i]; \
+\
+                uint##bits##_t *tmp = src; \
+                src = dst; \
+                dst = tmp; \
+        } \
+\
+        if (src != keys) \
+                memcpy(keys, src, len * sizeof(*keys)); \
+}
+
+DECL_RADIX_SORT(32)
+DECL_RADIX_SORT(64)
+
+/**
+ * @brief Sorts 'data' by radix if 'type' is supported.
+ *
+ * @return 0 on success.
+ * @return -ENOTSUP if 'type' or 'len' are not suited for a radix sort.
+ * @return -ENOMEM on failure, in which case 'data' is left untouched.
+ */
+static int radix_sort(void *data, size_t len, const struct type_info *type)
+{
+        const enum radix_key key = radix_key(type);
+        if (key == RADIX_KEY_NONE || len < RADIX_SORT_MIN_LEN)
+                return -ENOTSUP;
+
+        if (type->size != sizeof(uint32_t) && type->size != sizeof(uint64_t))
+                return -ENOTSUP;
+
+        void *scratch = malloc(len * type->size);
+        if (!scratch)
+                return -ENOMEM;
+
+        if (type->size == sizeof(uint32_t)) {
+                to_keys_32(data, len, key);
+                radix_sort_32(data, scratch, len);
+                from_keys_32(data, len, key);
+        } else {
+                to_keys_64(data, len, key);
+                radix_sort_64(data, scratch, len);
+                from_keys_64(data, len, key);
+        }
+
+        free(scratch);
+        return 0;
+}
+
+/* String sort -----------------------*/
+
+static uint64_t string_prefix(const char *string)
+{
+        uint64_t prefix = 0;
+        unsigned int i;
+
+        for (i = 0; i < sizeof(prefix); ++i) {
+                prefix <<= 8;
+                if (string[i])
+                        prefix |= (unsigned char)string[i];
+                else
+                        break;
+        }
+
+        return (i < sizeof(prefix) ? prefix << (8 * (sizeof(prefix) - i - 1))
+                        : prefix);
+}
+
+/**
+ * @brief Loads the prefixes of the strings of 'keys' at 'depth'.
+ */
+static void string_load(struct string_key *keys, size_t len, size_t depth)
+{
+        for (size_t i = 0; i < len; ++i)
+                keys[i].prefix = string_prefix(keys[i].string + depth);
+}
+
+/**
+ * @brief Compares the strings of 'a' and 'b', whose first 'depth' bytes are
+ * equal and whose prefixes are loaded at 'depth'.
+ */
+static int string_comp(
+                const struct string_key *a,
+                const struct string_key *b,
+                size_t depth)
+{
+        if (a->prefix != b->prefix)
+                return (a->prefix > b->prefix) - (a->prefix < b->prefix);
+
+        /* A zero last byte means both strings ended within the prefix */
+        if ((a->prefix & 0xff) == 0)
+                return 0;
+
+        depth += sizeof(a->prefix);
+        return strcmp(a->string + depth, b->string + depth);
+}
+
+static void string_insertion_sort(
+                struct string_key *keys,
+                size_t len,
+                size_t depth)
+{
+        for (size_t i = 1; i < len; ++i) {
+                const struct string_key tmp = keys[i];
+                size_t j = i;
+
+                while (j > 0 && string_comp(&keys[j - 1], &tmp, depth) > 0) {
+                        keys[j] = keys[j - 1];
+                        --j;
+                }
+
+                keys[j] = tmp;
+        }
+}
+
+static void string_sort(struct string_key *keys, size_t len, size_t depth);
+
+/**
+ * @brief Sorts 'keys', whose strings share their first 'depth' + 8 bytes, on
+ * the bytes that follow.
+ */
+static void string_sort_next(
+                struct string_key *keys,
+                size_t len,
+                size_t depth)
+{
+        if (len < 2)
+                return;
+
+        depth += sizeof(keys->prefix);
+        string_load(keys, len, depth);
+        string_sort(keys, len, depth);
+}
+
+static uint64_t median_prefix(uint64_t a, uint64_t b, uint64_t c)
+{
+        if (a < b)
+                return (b < c ? b : (a < c ? c : a));
+
+        return (a < c ? a : (b < c ? c : b));
+}
+
+/**
+ * @brief Sorts 'keys', whose strings share their first 'depth' bytes and whose
+ * prefixes are loaded at 'depth', by multikey quicksort : keys are split in
+ * three around a pivot prefix and the keys equal to the pivot are sorted on
+ * the next 8 bytes. The largest part is handled by the loop to bound the
+ * recursion.
+ */
+static void string_sort(struct string_key *keys, size_t len, size_t depth)
+{
+        while (len >= STRING_INSERTION_LEN) {
+                const uint64_t pivot = median_prefix(keys[0].prefix,
+                                keys[len / 2].prefix, keys[len - 1].prefix);
+                size_t lt = 0;
+                size_t gt = len;
+
+                /* [0, lt[ < pivot, [lt, i[ == pivot, [gt, len[ > pivot */
+                for (size_t i = 0; i < gt;) {
+                        const struct string_key tmp = keys[i];
+
+                        if (tmp.prefix < pivot) {
+                                keys[i++] = keys[lt];
+                                keys[lt++] = tmp;
+                        } else if (tmp.prefix > pivot) {
+                                keys[i] = keys[--gt];
+                                keys[gt] = tmp;
+                        } else {
+                                ++i;
+                        }
+                }
+
+                /* Keys equal to a pivot ending with a zero are sorted */
+                struct string_key *equal = keys + lt;
+                const size_t equal_len = ((pivot & 0xff) ? gt - lt : 0);
+                const size_t greater_len = len - gt;
+
+                if (lt >= greater_len && lt >= equal_len) {
+                        string_sort_next(equal, equal_len, depth);
+                        string_sort(keys + gt, greater_len, depth);
+                        len = lt;
+                } else if (greater_len >= equal_len) {
+                        string_sort(keys, lt, depth);
+                        string_sort_next(equal, equal_len, depth);
+                        keys += gt;
+                        len = greater_len;
+                } else {
+                        string_sort(keys, lt, depth);
+                        string_sort(keys + gt, greater_len, depth);
+                        keys = equal;
+                        len = equal_len;
+                        depth += sizeof(pivot);
+                        string_load(keys, len, depth);
+                }
+        }
+
+        string_insertion_sort(keys, len, depth);
+}
+
+/**
+ * @brief Sorts 'data' by multikey quicksort if 'type' is a type_string().
+ * NULL strings come first, as with the 'comp' callback of type_string().
+ *
+ * @return 0 on success.
+ * @return -ENOTSUP if 'type' or 'len' are not suited for a string sort.
+ * @return -ENOMEM on failure, in which case 'data' is left untouched.
+ */
+static int string_sort_typed(
+                void *data,
+                size_t len,
+                const struct type_info *type)
+{
+        if (type != type_string(TYPE_DESTROY_POLICY_AUTO_FREE)
+                        && type != type_string(TYPE_DESTROY_POLICY_NO_FREE))
+                return -ENOTSUP;
+
+        if (len < STRING_SORT_MIN_LEN)
+                return -ENOTSUP;
+
+        struct type_string *strings = data;
+        size_t nulls = 0;
+
+        struct string_key *keys = malloc(len * sizeof(*keys));
+        if (!keys)
+                return -ENOMEM;
+
+        size_t count = 0;
+        for (size_t i = 0; i < len; ++i) {
+                if (!strings[i].string)
+                        ++nulls;
+                else
+                        keys[count++].string = strings[i].string;
+        }
+
+        string_load(keys, count, 0);
+        string_sort(keys, count, 0);
+
+        for (size_t i = 0; i < nulls; ++i)
+                strings[i].string = NULL;
+
+        for (size_t i = 0; i < count; ++i)
+                strings[nulls + i].string = (char *)keys[i].string;
+
+        free(keys);
+        return 0;
+}
+
+/* Parallel sort ---------------------*/
+
+/**
+ * @brief Returns how many elements of 'a' are part of the first 'rank'
+ * elements of the merge of 'a' and 'b'.
+ */
+static size_t co_rank(
+                size_t rank,
+                const char *a,
+                size_t a_len,
+                const char *b,
+                size_t b_len,
+                size_t size,
+                type_comp_cb comp)
+{
+        size_t low = (rank > b_len ? rank - b_len : 0);
+        size_t high = MIN(rank, a_len);
+
+        while (low < high) {
+                const size_t i = low + (high - low) / 2;
+                const size_t j = rank - i;
+
+                /* a[i] comes before b[j - 1], so it is part of the rank */
+                if (comp(a + i * size, b + (j - 1) * size) <= 0)
+                        low = i + 1;
+                else
+                        high = i;
+        }
+
+        return low;
+}
+
+static void sort_run_task(size_t index, void *arg)
+{
+        const struct sort_job *job = arg;
+        const size_t first = job->bounds[index];
+        const size_t len = job->bounds[index + 1] - first;
+        char *data = job->data + first * job->size;
+
+        if (job->stable) {
+                merge_sort(data, len, job->size, job->comp,
+                                job->scratch + first * job->size);
+        } else {
+                qsort(data, len, job->size, job->comp);
+        }
+}
+
+static void merge_task(size_t index, void *arg)
+{
+        const struct sort_job *job = arg;
+        const struct merge_task *task = &job->tasks[index];
+        const size_t size = job->size;
+
+        const char *a = job->src + task->first * size;
+        const size_t a_len = task->middle - task->first;
+        const char *b = job->src + task->middle * size;
+        const size_t b_len = task->last - task->middle;
+
+        const size_t a_first = co_rank(task->out_first,
+                        a, a_len, b, b_len, size, job->comp);
+        const size_t a_last = co_rank(task->out_last,
+                        a, a_len, b, b_len, size, job->comp);
+        const size_t b_first = task->out_first - a_first;
+        const size_t b_last = task->out_last - a_last;
+
+        merge(a + a_first * size, a_last - a_first,
+                        b + b_first * size, b_last - b_first,
+                        job->dst + (task->first + task->out_first) * size,
+                        size, job->comp);
+}
+
+/**
+ * @brief Fills the tasks of 'job' to merge its runs two by two, splitting each
+ * merge in as many tasks as its share of the threads.
+ *
+ * @return The number of tasks.
+ */
+static size_t plan_merge_round(struct sort_job *job, size_t threads)
+{
+        size_t count = 0;
+
+        for (size_t run = 0; run < job->runs; run += 2) {
+                const size_t first = job->bounds[run];
+                const size_t middle = job->bounds[MIN(run + 1, job->runs)];
+                const size_t last = job->bounds[MIN(run + 2, job->runs)];
+                const size_t len = last - first;
+                const size_t pieces = 1 + threads * len / job->len;
+
+                for (size_t i = 0; i < pieces; ++i) {
+                        job->tasks[count++] = (struct merge_task) {
+                                .first = first,
+                                .middle = middle,
+                                .last = last,
+                                .out_first = len * i / pieces,
+                                .out_last = len * (i + 1) / pieces
+                        };
+                }
+        }
+
+        return count;
+}
+
+/* API -----------------------------------------------------------------------*/
+
+void sort_typed(void *data, size_t len, const struct type_info *type)
+{
+        if (radix_sort(data, len, type) == 0)
+                return;
+
+        if (string_sort_typed(data, len, type) == 0)
+                return;
+
+        qsort(data, len, type->size, type->comp);
+}
+
+int sort_stable(void *data, size_t len, size_t size, type_comp_cb comp)
+{
+        if (len < 2)
+                return 0;
+
+        char *scratch = malloc(len * size);
+        if (!scratch)
+                return -ENOMEM;
+
+        merge_sort(data, len, size, comp, scratch);
+        free(scratch);
+
+        return 0;
+}
+
+void sort_partial(
+                void *data,
+                size_t len,
+                size_t size,
+                type_comp_cb comp,
+                size_t k)
+{
+        char *elements = data;
+
+        k = MIN(k, len);
+        if (k == 0)
+                return;
+
+        /* The k lowest elements seen so far are kept in a max heap */
+        for (size_t i = k / 2; i-- > 0;)
+                sift_down(elements, k, size, comp, HEAP_ORDER_MAX, i);
+
+        for (size_t i = k; i < len; ++i) {
+                char *element = elements + i * size;
+                if (comp(element, elements) >= 0)
+                        continue;
+
+                swap_elements(element, elements, size);
+                sift_down(elements, k, size, comp, HEAP_ORDER_MAX, 0);
+        }
+
+        heap_sort(elements, k, size, comp, HEAP_ORDER_MAX);
+}
+
+void sort_select(
+                void *data,
+                size_t len,
+                size_t size,
+                type_comp_cb comp,
+                size_t k)
+{
+        char *elements = data;
+        size_t first = 0;
+        size_t last = len;
+        unsigned int budget = 0;
+
+        /* Past 2 * log2(len) partitions, pivots are considered unlucky */
+        for (size_t i = len; i > 1; i /= 2)
+                budget += 2;
+
+        while (last - first > SELECT_INSERTION_LEN) {
+                if (budget-- == 0) {
+                        sort_partial(elements + first * size, last - first,
+                                        size, comp, k - first + 1);
+                        return;
+                }
+
+                const size_t pivot = first + partition(elements + first * size,
+                                last - first, size, comp);
+                if (pivot == k)
+                        return;
+
+                if (k < pivot)
+                        last = pivot;
+                else
+                        first = pivot + 1;
+        }
+
+        swap_insertion_sort(elements + first * size, last - first, size, comp);
+}
+
+void heap_push(
+                void *data,
+                size_t len,
+                size_t size,
+                type_comp_cb comp,
+                enum heap_order order)
+{
+        char *elements = data;
+        size_t pos = len - 1;
+
+        while (pos > 0) {
+                const size_t parent = (pos - 1) / 2;
+                if (!heap_above(elements + pos * size,
+                                elements + parent * size, comp, order))
+                        return;
+
+                swap_elements(elements + pos * size,
+                                elements + parent * size, size);
+                pos = parent;
+        }
+}
+
+void heap_fix_top(
+                void *data,
+                size_t len,
+                size_t size,
+                type_comp_cb comp,
+                enum heap_order order)
+{
+        sift_down(data, len, size, comp, order, 0);
+}
+
+void heap_sort(
+                void *data,
+                size_t len,
+                size_t size,
+                type_comp_cb comp,
+                enum heap_order order)
+{
+        char *elements = data;
+
+        while (len > 1) {
+                --len;
+                swap_elements(elements, elements + len * size, size);
+                sift_down(elements, len, size, comp, order, 0);
+        }
+}
+
+int sort_parallel(
+                void *data,
+                size_t len,
+                size_t size,
+                type_comp_cb comp,
+                bool stable)
+{
+        const size_t threads = threads_count();
+        int res = -ENOMEM;
+
+        if (threads <= 1 || len < PAR_SORT_MIN_LEN) {
+                if (stable)
+                        return sort_stable(data, len, size, comp);
+
+                qsort(data, len, size, comp);
+                return 0;
+        }
+
+        struct sort_job job = {
+                .data = data,
+                .len = len,
+                .size = size,
+                .comp = comp,
+                .stable = stable,
+                .runs = threads
+        };
+
+        job.scratch = malloc(len * size);
+        if (!job.scratch)
+                goto error_alloc_scratch;
+
+        job.bounds = calloc(job.runs + 1, sizeof(*job.bounds));
+        if (!job.bounds)
+                goto error_alloc_bounds;
+
+        /* Each merge round has at most one task per run and one per thread */
+        job.tasks = calloc(job.runs + threads, sizeof(*job.tasks));
+        if (!job.tasks)
+                goto error_alloc_tasks;
+
+        for (size_t i = 0; i <= job.runs; ++i)
+                job.bounds[i] = len * i / job.runs;
+
+        threads_run(job.runs, sort_run_task, &job);
+
+        job.src = job.data;
+        job.dst = job.scratch;
+        while (job.runs > 1) {
+                const size_t count = plan_merge_round(&job, threads);
+                threads_run(count, merge_task, &job);
+
+                job.runs = (job.runs + 1) / 2;
+                for (size_t i = 0; i < job.runs; ++i)
+                        job.bounds[i] = job.bounds[2 * i];
+
+                job.bounds[job.runs] = len;
+
+                char *tmp = (char *)job.src;
+                job.src = job.dst;
+                job.dst = tmp;
+        }
+
+        if (job.src != job.data)
+                memcpy(job.data, job.src, len * size);
+
+        res = 0;
+        free(job.tasks);
+error_alloc_tasks:
+        free(job.bounds);
+error_alloc_bounds:
+        free(job.scratch);
+error_alloc_scratch:
+        return res;
+}
@@ -0,0 +1,123 @@
+/**
+ * @author Maxence ROBIN
+ * @brief Provides sorting algorithms over contiguous elements.
+ */
+
+#ifndef LIB_SORTS_H
+#define LIB_SORTS_H
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_types.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Definitions ---------------------------------------------------------------*/
+
+/**
+ * @brief Order of the heaps handled by heap_*() functions : the top of a
+ * HEAP_ORDER_MAX heap is its greatest element, the top of a HEAP_ORDER_MIN
+ * heap its lowest one.
+ */
+enum heap_order {
+        HEAP_ORDER_MAX,
+        HEAP_ORDER_MIN
+};
+
+/* API -----------------------------------------------------------------------*/
+
+/**
+ * @brief Sorts the 'len' elements of 'type' of 'data' in ascending order
+ * following the 'comp' callback of 'type', with the fastest algorithm known
+ * for 'type'. Elements of built-in numeric types are sorted by radix and
+ * strings by multikey quicksort.
+ */
+void sort_typed(void *data, size_t len, const struct type_info *type);
+
+/**
+ * @brief Sorts the 'len' elements of 'size' bytes of 'data' in ascending order
+ * following 'comp'. Equal elements keep their relative order.
+ *
+ * @return 0 on success.
+ * @return -ENOMEM on failure, in which case 'data' is left untouched.
+ */
+int sort_stable(void *data, size_t len, size_t size, type_comp_cb comp);
+
+/**
+ * @brief Sorts the 'len' elements of 'size' bytes of 'data' in ascending order
+ * following 'comp', splitting the work between the threads of the pool. If
+ * 'stable' is true, equal elements keep their relative order.
+ *
+ * @return 0 on success.
+ * @return -ENOMEM on failure, in which case 'data' is left untouched.
+ */
+int sort_parallel(
+                void *data,
+                size_t len,
+                size_t size,
+                type_comp_cb comp,
+                bool stable);
+
+/**
+ * @brief Moves the 'k' lowest of the 'len' elements of 'size' bytes of 'data'
+ * to its beginning, sorted in ascending order following 'comp'. The order of
+ * the other elements is unspecified.
+ */
+void sort_partial(
+                void *data,
+                size_t len,
+                size_t size,
+                type_comp_cb comp,
+                size_t k);
+
+/**
+ * @brief Moves to position 'k' of 'data' the element that would be there if
+ * the 'len' elements of 'size' bytes of 'data' were sorted following 'comp'.
+ * Elements before it are lower or equal, elements after it are greater or
+ * equal.
+ *
+ * @note 'k' MUST be lower than 'len'.
+ */
+void sort_select(
+                void *data,
+                size_t len,
+                size_t size,
+                type_comp_cb comp,
+                size_t k);
+
+/**
+ * @brief Adds the last of the 'len' elements of 'size' bytes of 'data' to the
+ * heap formed by the 'len' - 1 first ones.
+ */
+void heap_push(
+                void *data,
+                size_t len,
+                size_t size,
+                type_comp_cb comp,
+                enum heap_order order);
+
+/**
+ * @brief Restores the heap formed by the 'len' elements of 'size' bytes of
+ * 'data' after its top was replaced.
+ */
+void heap_fix_top(
+                void *data,
+                size_t len,
+                size_t size,
+                type_comp_cb comp,
+                enum heap_order order);
+
+/**
+ * @brief Sorts the heap formed by the 'len' elements of 'size' bytes of
+ * 'data' : a HEAP_ORDER_MAX heap ends up in ascending order, a HEAP_ORDER_MIN
+ * heap in descending order.
+ */
+void heap_sort(
+                void *data,
+                size_t len,
+                size_t size,
+                type_comp_cb comp,
+                enum heap_order order);
+
+#endif /* LIB_SORTS_H */
@@ -0,0 +1,250 @@
+/**
+ * @author Maxence ROBIN
+ * @brief Provides lock-free single-producer single-consumer circular buffers
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_allocators_private.h"
+#include "lib_spsc_buffers.h"
+#include "lib_waits.h"
+
+#include <errno.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Definitions ---------------------------------------------------------------*/
+
+#define CACHE_LINE_SIZE 64
+
+/*
+ * 'read' and 'write' count every value ever popped and pushed, the slot of a
+ * value is its index masked by 'mask'. Each side keeps the last index of the
+ * other side it has seen, and only loads the shared one again when this cached
+ * copy tells the buffer is full or empty.
+ */
+struct spsc_buffer {
+        /* Consumer side */
+        alignas(CACHE_LINE_SIZE) atomic_size_t read;
+        size_t cached_write;
+
+        /* Producer side */
+        alignas(CACHE_LINE_SIZE) atomic_size_t write;
+        size_t cached_read;
+
+        /* Waits, only written when a thread has to wait */
+        alignas(CACHE_LINE_SIZE) struct wait_event not_empty;
+        struct wait_event not_full;
+
+        /* Read-only after creation */
+        alignas(CACHE_LINE_SIZE) const struct allocator *allocator;
+        const struct type_info *type;
+        void *base; /* Start of the allocation, before alignment */
+        size_t size; /* Of the allocation */
+        size_t mask; /* Number of slots - 1 */
+        char *slots;
+};
+
+/* Static functions ----------------------------------------------------------*/
+
+static char *slot(const struct spsc_buffer *buffer, size_t index)
+{
+        return buffer->slots + (index & buffer->mask) * buffer->type->size;
+}
+
+/**
+ * @brief Returns the lowest power of two greater or equal to 'count', or 0 if
+ * there is none.
+ */
+static size_t round_up_pow2(size_t count)
+{
+        size_t pow2 = 1;
+        while (pow2 < count && pow2 <= SIZE_MAX / 2)
+                pow2 *= 2;
+
+        return (pow2 >= count ? pow2 : 0);
+}
+
+static void destroy_values(const struct spsc_buffer *buffer)
+{
+        const size_t write = atomic_load(&buffer->write);
+        for (size_t i = atomic_load(&buffer->read); i != write; ++i)
+                buffer->type->destroy(slot(buffer, i));
+}
+
+/* API -----------------------------------------------------------------------*/
+
+struct spsc_buffer *spsc_buffer_create(
+                const struct type_info *type, size_t count)
+{
+        return spsc_buffer_create_with(type, count, allocator_default());
+}
+
+struct spsc_buffer *spsc_buffer_create_with(
+                const struct type_info *type,
+                size_t count,
+                const struct allocator *allocator)
+{
+        if (!type || count == 0 || !allocator_is_valid(allocator))
+                return NULL;
+
+        if (type->size == 0 || !type->copy || !type->destroy)
+                return NULL;
+
+        count = round_up_pow2(count);
+        if (count == 0 || count > (SIZE_MAX / 2) / type->size)
+                return NULL;
+
+        /* Room to align the buffer on a cache line */
+        const size_t size = CACHE_LINE_SIZE + sizeof(struct spsc_buffer)
+                        + count * type->size;
+
+        void *base = allocator_calloc(allocator, size);
+        if (!base)
+                return NULL;
+
+        const uintptr_t aligned = ((uintptr_t)base + CACHE_LINE_SIZE - 1)
+                        & ~(uintptr_t)(CACHE_LINE_SIZE - 1);
+        struct spsc_buffer *buffer = (struct spsc_buffer *)aligned;
+
+        atomic_init(&buffer->read, 0);
+        atomic_init(&buffer->write, 0);
+        buffer->cached_write = 0;
+        buffer->cached_read = 0;
+        wait_event_init(&buffer->not_empty);
+        wait_event_init(&buffer->not_full);
+        buffer->allocator = allocator;
+        buffer->type = type;
+        buffer->base = base;
+        buffer->size = size;
+        buffer->mask = count - 1;
+        buffer->slots = (char *)(buffer + 1);
+
+        return buffer;
+}
+
+void spsc_buffer_destroy(const struct spsc_buffer *buffer)
+{
+        if (!buffer)
+                return;
+
+        destroy_values(buffer);
+        allocator_free(buffer->allocator, buffer->base, buffer->size);
+}
+
+int spsc_buffer_push(struct spsc_buffer *buffer, const void *data)
+{
+        if (!buffer || !data)
+                return -EINVAL;
+
+        const size_t write = atomic_load_explicit(
+                        &buffer->write, memory_order_relaxed);
+
+        if (write - buffer->cached_read > buffer->mask) {
+                buffer->cached_read = atomic_load_explicit(
+                                &buffer->read, memory_order_acquire);
+                if (write - buffer->cached_read > buffer->mask)
+                        return -ENOBUFS;
+        }
+
+        /* The slot may still hold a value moved out by the consumer */
+        char *dest = slot(buffer, write);
+        memset(dest, 0, buffer->type->size);
+        buffer->type->copy(dest, data);
+
+        atomic_store_explicit(&buffer->write, write + 1, memory_order_release);
+        wait_event_notify(&buffer->not_empty);
+        return 0;
+}
+
+int spsc_buffer_pop(struct spsc_buffer *buffer, void *data)
+{
+        if (!buffer || !data)
+                return -EINVAL;
+
+        const size_t read = atomic_load_explicit(
+                        &buffer->read, memory_order_relaxed);
+
+        if (read == buffer->cached_write) {
+                buffer->cached_write = atomic_load_explicit(
+                                &buffer->write, memory_order_acquire);
+                if (read == buffer->cached_write)
+                        return -ENOMEM;
+        }
+
+        memcpy(data, slot(buffer, read), buffer->type->size);
+
+        atomic_store_explicit(&buffer->read, read + 1, memory_order_release);
+        wait_event_notify(&buffer->not_full);
+        return 0;
+}
+
+int spsc_buffer_push_wait(
+                struct spsc_buffer *buffer, const void *data, int timeout)
+{
+        struct timespec deadline;
+        wait_deadline(&deadline, timeout);
+
+        while (true) {
+                int ret = spsc_buffer_push(buffer, data);
+                if (ret != -ENOBUFS)
+                        return ret;
+
+                const unsigned int key = wait_event_prepare(&buffer->not_full);
+
+                ret = spsc_buffer_push(buffer, data);
+                if (ret != -ENOBUFS) {
+                        wait_event_cancel(&buffer->not_full);
+                        return ret;
+                }
+
+                if (wait_event_wait(&buffer->not_full, key, &deadline) < 0)
+                        return -ETIMEDOUT;
+        }
+}
+
+int spsc_buffer_pop_wait(
+                struct spsc_buffer *buffer, void *data, int timeout)
+{
+        struct timespec deadline;
+        wait_deadline(&deadline, timeout);
+
+        while (true) {
+                int ret = spsc_buffer_pop(buffer, data);
+                if (ret != -ENOMEM)
+                        return ret;
+
+                const unsigned int key = wait_event_prepare(&buffer->not_empty);
+
+                ret = spsc_buffer_pop(buffer, data);
+                if (ret != -ENOMEM) {
+                        wait_event_cancel(&buffer->not_empty);
+                        return ret;
+                }
+
+                if (wait_event_wait(&buffer->not_empty, key, &deadline) < 0)
+                        return -ETIMEDOUT;
+        }
+}
+
+ssize_t spsc_buffer_len(const struct spsc_buffer *buffer)
+{
+        if (!buffer)
+                return -EINVAL;
+
+        const size_t read = atomic_load(&buffer->read);
+        const size_t write = atomic_load(&buffer->write);
+
+        return (ssize_t)(write - read);
+}
+
+ssize_t spsc_buffer_count(const struct spsc_buffer *buffer)
+{
+        if (!buffer)
+                return -EINVAL;
+
+        return (ssize_t)(buffer->mask + 1);
+}
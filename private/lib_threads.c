@@ -0,0 +1,230 @@
+/**
+ * @author Maxence ROBIN
+ * @brief Provides the thread pool shared by the parallel algorithms.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_threads.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/* Definitions ---------------------------------------------------------------*/
+
+struct job {
+        threads_task_cb task;
+        void *arg;
+        size_t count;
+        atomic_size_t next;
+};
+
+struct pool {
+        pthread_mutex_t lock;
+        pthread_cond_t work_cond;
+        pthread_cond_t done_cond;
+        pthread_t *workers;
+        size_t worker_count;
+        size_t thread_count; /* 0 until first use */
+        bool stopping;
+        unsigned long generation;
+        struct job *job;
+        size_t active; /* Workers currently holding 'job' */
+};
+
+/* Only one job runs at a time, this lock is held for its whole duration */
+static pthread_mutex_t run_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static struct pool pool = {
+        .lock = PTHREAD_MUTEX_INITIALIZER,
+        .work_cond = PTHREAD_COND_INITIALIZER,
+        .done_cond = PTHREAD_COND_INITIALIZER
+};
+
+static _Thread_local bool in_task;
+
+/* Static functions ----------------------------------------------------------*/
+
+static void run_tasks(struct job *job)
+{
+        size_t i;
+
+        in_task = true;
+        while ((i = atomic_fetch_add(&job->next, 1)) < job->count)
+                job->task(i, job->arg);
+
+        in_task = false;
+}
+
+static void *worker_main(void *arg)
+{
+        unsigned long generation = 0;
+
+        pthread_mutex_lock(&pool.lock);
+        while (true) {
+                while (!pool.stopping && pool.generation == generation)
+                        pthread_cond_wait(&pool.work_cond, &pool.lock);
+
+                if (pool.stopping)
+                        break;
+
+                generation = pool.generation;
+
+                /* The job may already be over if this worker woke up late */
+                struct job *job = pool.job;
+                if (!job)
+                        continue;
+
+                ++pool.active;
+                pthread_mutex_unlock(&pool.lock);
+
+                run_tasks(job);
+
+                pthread_mutex_lock(&pool.lock);
+                if (--pool.active == 0)
+                        pthread_cond_signal(&pool.done_cond);
+        }
+
+        pthread_mutex_unlock(&pool.lock);
+        return NULL;
+}
+
+static size_t default_thread_count(void)
+{
+        const long count = sysconf(_SC_NPROCESSORS_ONLN);
+        return (count > 0 ? (size_t)count : 1);
+}
+
+/**
+ * @brief Starts the workers of the pool if they are not started yet. If some
+ * workers could not be created, the pool runs with the ones that were.
+ *
+ * @note 'run_lock' MUST be held.
+ */
+static void start_workers(void)
+{
+        if (pool.workers || pool.thread_count == 1)
+                return;
+
+        if (pool.thread_count == 0)
+                pool.thread_count = default_thread_count();
+
+        const size_t count = pool.thread_count - 1;
+        if (count == 0)
+                return;
+
+        pool.workers = calloc(count, sizeof(*pool.workers));
+        if (!pool.workers)
+                return;
+
+        pool.stopping = false;
+        for (pool.worker_count = 0; pool.worker_count < count;
+                        ++pool.worker_count) {
+                if (pthread_create(&pool.workers[pool.worker_count],
+                                NULL, worker_main, NULL) != 0)
+                        break;
+        }
+}
+
+/**
+ * @brief Stops and joins the workers of the pool.
+ *
+ * @note 'run_lock' MUST be held.
+ */
+static void stop_workers(void)
+{
+        if (!pool.workers)
+                return;
+
+        pthread_mutex_lock(&pool.lock);
+        pool.stopping = true;
+        pthread_cond_broadcast(&pool.work_cond);
+        pthread_mutex_unlock(&pool.lock);
+
+        for (size_t i = 0; i < pool.worker_count; ++i)
+                pthread_join(pool.workers[i], NULL);
+
+        free(pool.workers);
+        pool.workers = NULL;
+        pool.worker_count = 0;
+}
+
+__attribute__((destructor)) static void destroy_pool(void)
+{
+        pthread_mutex_lock(&run_lock);
+        stop_workers();
+        pthread_mutex_unlock(&run_lock);
+}
+
+/* API -----------------------------------------------------------------------*/
+
+void threads_run(size_t count, threads_task_cb task, void *arg)
+{
+        struct job job = {
+                .task = task,
+                .arg = arg,
+                .count = count,
+                .next = 0
+        };
+
+        if (in_task || count <= 1) {
+                for (size_t i = 0; i < count; ++i)
+                        task(i, arg);
+
+                return;
+        }
+
+        pthread_mutex_lock(&run_lock);
+        start_workers();
+
+        pthread_mutex_lock(&pool.lock);
+        pool.job = &job;
+        ++pool.generation;
+        pthread_cond_broadcast(&pool.work_cond);
+        pthread_mutex_unlock(&pool.lock);
+
+        run_tasks(&job);
+
+        /* Every task is claimed, waiting for the ones still running */
+        pthread_mutex_lock(&pool.lock);
+        while (pool.active > 0)
+                pthread_cond_wait(&pool.done_cond, &pool.lock);
+
+        pool.job = NULL;
+        pthread_mutex_unlock(&pool.lock);
+
+        pthread_mutex_unlock(&run_lock);
+}
+
+size_t threads_count(void)
+{
+        /* 'run_lock' is held by the running job, nested calls are sequential */
+        if (in_task)
+                return 1;
+
+        pthread_mutex_lock(&run_lock);
+        if (pool.thread_count == 0)
+                pool.thread_count = default_thread_count();
+
+        const size_t count = pool.thread_count;
+        pthread_mutex_unlock(&run_lock);
+
+        return count;
+}
+
+int threads_set_count(size_t count)
+{
+        if (in_task)
+                return -EBUSY;
+
+        pthread_mutex_lock(&run_lock);
+        stop_workers();
+        pool.thread_count = (count > 0 ? count : default_thread_count());
+        pthread_mutex_unlock(&run_lock);
+
+        return 0;
+}
@@ -0,0 +1,46 @@
+/**
+ * @author Maxence ROBIN
+ * @brief Provides the thread pool shared by the parallel algorithms.
+ */
+
+#ifndef LIB_THREADS_H
+#define LIB_THREADS_H
+
+/* Includes ------------------------------------------------------------------*/
+
+#include <stddef.h>
+
+/* Definitions ---------------------------------------------------------------*/
+
+typedef void (*threads_task_cb)(size_t, void *);
+
+/* API -----------------------------------------------------------------------*/
+
+/**
+ * @brief Calls 'task' for every index in [0, 'count'[ with 'arg' passed as a
+ * second parameter, spreading the calls over the threads of the pool. The
+ * calling thread takes part in the work and the call returns once every task
+ * is done.
+ *
+ * @note Calls made from inside a task run sequentially on the calling thread.
+ */
+void threads_run(size_t count, threads_task_cb task, void *arg);
+
+/**
+ * @brief Returns the number of threads working on a call to threads_run(),
+ * including the calling thread. From inside a task, returns 1 since nested
+ * calls run sequentially.
+ */
+size_t threads_count(void);
+
+/**
+ * @brief Sets the number of threads working on a call to threads_run(),
+ * including the calling thread. If 'count' is 0, one thread per online CPU is
+ * used.
+ *
+ * @return 0 on success.
+ * @return -EBUSY if called from inside a task.
+ */
+int threads_set_count(size_t count);
+
+#endif /* LIB_THREADS_H */
@@ -23,7 +23,10 @@ static void copy_##name(void *dest, const void *src) \
 \
 static int comp_##name(const void *first, const void *second) \
 { \
-        return *((type *)first) - *((type *)second); \
+        const type a = *((type *)first); \
+        const type b = *((type *)second); \
+\
+        return (a > b) - (a < b); \
 }
 
 /* Hashable types --------------------*/
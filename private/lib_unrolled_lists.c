@@ -0,0 +1,740 @@
+/**
+ * @author Maxence ROBIN
+ * @brief Provides unrolled doubly-linked list manipulation
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_allocators_private.h"
+#include "lib_iterators_private.h"
+#include "lib_slabs.h"
+#include "lib_unrolled_lists.h"
+
+#include <errno.h>
+#include <stdalign.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+/* Definitions ---------------------------------------------------------------*/
+
+#define CHUNK_SIZE 256 /* Bytes, header included */
+#define CHUNK_MIN_LEN 8 /* Elements, for types too large for CHUNK_SIZE */
+
+/*
+ * Chunks are allocated along with their elements in a single object :
+ * | struct chunk | elements |
+ * Elements occupy the slots ['start', 'start' + 'len'[, which leaves room at
+ * both ends for pushes without moving the other elements.
+ */
+struct chunk {
+        struct chunk *next;
+        struct chunk *previous;
+        size_t start;
+        size_t len;
+};
+
+/* Offset of the first slot from the start of its chunk */
+#define CHUNK_DATA_OFFSET \
+        ((sizeof(struct chunk) + alignof(max_align_t) - 1) \
+                        / alignof(max_align_t) * alignof(max_align_t))
+
+struct ulist {
+        const struct allocator *allocator;
+        const struct type_info *type;
+        size_t len;
+        size_t capacity; /* Slots per chunk */
+        struct slab_pool chunks;
+        struct chunk base_chunk; /* Always empty, simplifies functions */
+};
+
+struct ulist_it {
+        struct iterator it; /* Placed at top for inheritance */
+        const struct allocator *allocator; /* May outlive 'ulist' */
+        const struct ulist *ulist;
+        struct chunk *chunk;
+        size_t index; /* Inside 'chunk', from its first element */
+};
+
+/* Static functions ----------------------------------------------------------*/
+
+/* Private utility functions ---------*/
+
+static char *slot(const struct ulist *ulist, struct chunk *chunk, size_t slot)
+{
+        return (char *)chunk + CHUNK_DATA_OFFSET + slot * ulist->type->size;
+}
+
+static void *element(
+                const struct ulist *ulist, struct chunk *chunk, size_t index)
+{
+        return slot(ulist, chunk, chunk->start + index);
+}
+
+/**
+ * @brief Moves 'count' elements of 'chunk' from slot 'src' to slot 'dest'.
+ */
+static void move_slots(
+                const struct ulist *ulist,
+                struct chunk *chunk,
+                size_t dest,
+                size_t src,
+                size_t count)
+{
+        memmove(slot(ulist, chunk, dest), slot(ulist, chunk, src),
+                        count * ulist->type->size);
+}
+
+/**
+ * @brief Inserts an empty chunk of 'ulist' before 'next' whose elements will
+ * start at slot 'start'.
+ *
+ * @return Pointer to the created chunk on success.
+ * @return NULL on failure.
+ */
+static struct chunk *insert_chunk(
+                struct ulist *ulist, struct chunk *next, size_t start)
+{
+        struct chunk *chunk = slab_alloc(&ulist->chunks);
+        if (!chunk)
+                return NULL;
+
+        chunk->start = start;
+        chunk->len = 0;
+
+        chunk->next = next;
+        chunk->previous = next->previous;
+
+        chunk->next->previous = chunk;
+        chunk->previous->next = chunk;
+
+        return chunk;
+}
+
+static void remove_chunk(struct ulist *ulist, struct chunk *chunk)
+{
+        chunk->next->previous = chunk->previous;
+        chunk->previous->next = chunk->next;
+        slab_free(&ulist->chunks, chunk);
+}
+
+/**
+ * @brief Moves the upper half of the elements of the full 'chunk' to a new
+ * chunk inserted after it.
+ *
+ * @return Pointer to the new chunk on success.
+ * @return NULL on failure.
+ */
+static struct chunk *split_chunk(struct ulist *ulist, struct chunk *chunk)
+{
+        struct chunk *upper = insert_chunk(ulist, chunk->next, 0);
+        if (!upper)
+                return NULL;
+
+        const size_t half = chunk->len / 2;
+
+        upper->len = chunk->len - half;
+        memcpy(slot(ulist, upper, 0), element(ulist, chunk, half),
+                        upper->len * ulist->type->size);
+        chunk->len = half;
+
+        return upper;
+}
+
+/**
+ * @brief Appends the elements of the chunk following 'chunk' to it, then
+ * removes that chunk.
+ */
+static void merge_next_chunk(struct ulist *ulist, struct chunk *chunk)
+{
+        struct chunk *next = chunk->next;
+
+        if (chunk->start + chunk->len + next->len > ulist->capacity) {
+                move_slots(ulist, chunk, 0, chunk->start, chunk->len);
+                chunk->start = 0;
+        }
+
+        memcpy(element(ulist, chunk, chunk->len), element(ulist, next, 0),
+                        next->len * ulist->type->size);
+        chunk->len += next->len;
+        remove_chunk(ulist, next);
+}
+
+/**
+ * @brief Finds the chunk holding the element at 'pos' inside 'ulist', walking
+ * from its closest end. 'index' is set to the index of the element inside the
+ * chunk.
+ *
+ * @note 'pos' MUST be lower than the length of 'ulist'.
+ */
+static struct chunk *find_chunk(
+                const struct ulist *ulist, size_t pos, size_t *index)
+{
+        struct chunk *chunk;
+
+        if (pos < ulist->len / 2) {
+                chunk = ulist->base_chunk.next;
+                for (; pos >= chunk->len; chunk = chunk->next)
+                        pos -= chunk->len;
+
+                *index = pos;
+        } else {
+                size_t rpos = ulist->len - pos;
+
+                chunk = ulist->base_chunk.previous;
+                for (; rpos > chunk->len; chunk = chunk->previous)
+                        rpos -= chunk->len;
+
+                *index = chunk->len - rpos;
+        }
+
+        return chunk;
+}
+
+/**
+ * @brief Inserts 'value' at 'index' inside 'chunk', splitting it first if it
+ * is full. Elements are moved toward the closest end of the chunk with room
+ * left.
+ *
+ * @return 0 on success.
+ * @return -ENOMEM on failure.
+ */
+static int insert_element(
+                struct ulist *ulist,
+                struct chunk *chunk,
+                size_t index,
+                const void *value)
+{
+        if (chunk->len == ulist->capacity) {
+                struct chunk *upper = split_chunk(ulist, chunk);
+                if (!upper)
+                        return -ENOMEM;
+
+                if (index > chunk->len) {
+                        index -= chunk->len;
+                        chunk = upper;
+                }
+        }
+
+        const bool room_front = (chunk->start > 0);
+        const bool room_back = (chunk->start + chunk->len < ulist->capacity);
+
+        if (room_front && (!room_back || index < chunk->len / 2)) {
+                move_slots(ulist, chunk, chunk->start - 1, chunk->start,
+                                index);
+                --chunk->start;
+        } else {
+                move_slots(ulist, chunk, chunk->start + index + 1,
+                                chunk->start + index, chunk->len - index);
+        }
+
+        ++chunk->len;
+        ++ulist->len;
+
+        /* The slot still holds a moved element, which 'copy' may free */
+        void *dest = element(ulist, chunk, index);
+        memset(dest, 0, ulist->type->size);
+        ulist->type->copy(dest, value);
+
+        return 0;
+}
+
+/**
+ * @brief Removes the element at 'index' inside 'chunk'. Elements are moved
+ * from the closest end of the chunk. Empty chunks are removed, and a chunk is
+ * merged with the next one once both fit in three quarters of a chunk.
+ *
+ * After the call, 'chunk' and 'index' point to the element following the
+ * removed one.
+ */
+static void remove_element(
+                struct ulist *ulist, struct chunk **chunk, size_t *index)
+{
+        struct chunk *current = *chunk;
+        const size_t i = *index;
+
+        ulist->type->destroy(element(ulist, current, i));
+
+        if (i < current->len / 2) {
+                move_slots(ulist, current, current->start + 1, current->start,
+                                i);
+                ++current->start;
+        } else {
+                move_slots(ulist, current, current->start + i,
+                                current->start + i + 1, current->len - i - 1);
+        }
+
+        --current->len;
+        --ulist->len;
+
+        struct chunk *next = current->next;
+
+        if (current->len == 0) {
+                remove_chunk(ulist, current);
+                current = next;
+        } else if (next != &ulist->base_chunk && current->len + next->len
+                        <= ulist->capacity - ulist->capacity / 4) {
+                merge_next_chunk(ulist, current);
+        }
+
+        if (current == *chunk && i < current->len) {
+                *index = i;
+        } else {
+                *chunk = (current == *chunk ? current->next : current);
+                *index = 0;
+        }
+}
+
+/**
+ * @brief Destroys every element of 'ulist', then releases all its chunks at
+ * once by releasing their slabs.
+ */
+static void clear_ulist(struct ulist *ulist)
+{
+        struct chunk *chunk = ulist->base_chunk.next;
+        for (; chunk != &ulist->base_chunk; chunk = chunk->next) {
+                for (size_t i = 0; i < chunk->len; ++i)
+                        ulist->type->destroy(element(ulist, chunk, i));
+        }
+
+        slab_pool_release(&ulist->chunks);
+
+        ulist->len = 0;
+        ulist->base_chunk.next = &ulist->base_chunk;
+        ulist->base_chunk.previous = &ulist->base_chunk;
+}
+
+/* API -----------------------------------------------------------------------*/
+
+struct ulist *ulist_create(const struct type_info *type)
+{
+        return ulist_create_with(type, allocator_default());
+}
+
+struct ulist *ulist_create_with(
+                const struct type_info *type,
+                const struct allocator *allocator)
+{
+        if (!type || !allocator_is_valid(allocator))
+                return NULL;
+
+        if (type->size == 0 || !type->copy || !type->destroy)
+                return NULL;
+
+        struct ulist *ulist = allocator_calloc(allocator, sizeof(*ulist));
+        if (!ulist)
+                return NULL;
+
+        size_t capacity = (CHUNK_SIZE - CHUNK_DATA_OFFSET) / type->size;
+        if (capacity < CHUNK_MIN_LEN)
+                capacity = CHUNK_MIN_LEN;
+
+        ulist->allocator = allocator;
+        ulist->type = type;
+        ulist->len = 0;
+        ulist->capacity = capacity;
+        slab_pool_init(&ulist->chunks,
+                        CHUNK_DATA_OFFSET + capacity * type->size, allocator);
+        ulist->base_chunk.next = &ulist->base_chunk;
+        ulist->base_chunk.previous = &ulist->base_chunk;
+
+        return ulist;
+}
+
+void ulist_destroy(const struct ulist *ulist)
+{
+        if (!ulist)
+                return;
+
+        clear_ulist((struct ulist *)ulist);
+        allocator_free(ulist->allocator, (struct ulist *)ulist,
+                        sizeof(*ulist));
+}
+
+int ulist_push_front(struct ulist *ulist, const void *value)
+{
+        if (!ulist || !value)
+                return -EINVAL;
+
+        /* New chunks are filled from their end by following pushes */
+        struct chunk *chunk = ulist->base_chunk.next;
+        if (chunk == &ulist->base_chunk || chunk->len == ulist->capacity) {
+                chunk = insert_chunk(ulist, chunk, ulist->capacity);
+                if (!chunk)
+                        return -ENOMEM;
+        }
+
+        return insert_element(ulist, chunk, 0, value);
+}
+
+int ulist_push_back(struct ulist *ulist, const void *value)
+{
+        if (!ulist || !value)
+                return -EINVAL;
+
+        struct chunk *chunk = ulist->base_chunk.previous;
+        if (chunk == &ulist->base_chunk || chunk->len == ulist->capacity) {
+                chunk = insert_chunk(ulist, &ulist->base_chunk, 0);
+                if (!chunk)
+                        return -ENOMEM;
+        }
+
+        return insert_element(ulist, chunk, chunk->len, value);
+}
+
+int ulist_insert(struct ulist *ulist, unsigned int pos, const void *value)
+{
+        if (!ulist || !value)
+                return -EINVAL;
+
+        if (pos > ulist->len)
+                return -ERANGE;
+
+        if (pos == 0)
+                return ulist_push_front(ulist, value);
+
+        if (pos == ulist->len)
+                return ulist_push_back(ulist, value);
+
+        size_t index;
+        struct chunk *chunk = find_chunk(ulist, pos, &index);
+
+        return insert_element(ulist, chunk, index, value);
+}
+
+int ulist_pop_front(struct ulist *ulist)
+{
+        if (!ulist)
+                return -EINVAL;
+
+        if (ulist->len == 0)
+                return -ENOBUFS;
+
+        struct chunk *chunk = ulist->base_chunk.next;
+        size_t index = 0;
+
+        remove_element(ulist, &chunk, &index);
+        return 0;
+}
+
+int ulist_pop_back(struct ulist *ulist)
+{
+        if (!ulist)
+                return -EINVAL;
+
+        if (ulist->len == 0)
+                return -ENOBUFS;
+
+        struct chunk *chunk = ulist->base_chunk.previous;
+        size_t index = chunk->len - 1;
+
+        remove_element(ulist, &chunk, &index);
+        return 0;
+}
+
+int ulist_remove(struct ulist *ulist, unsigned int pos)
+{
+        if (!ulist)
+                return -EINVAL;
+
+        if (pos >= ulist->len)
+                return -ERANGE;
+
+        size_t index;
+        struct chunk *chunk = find_chunk(ulist, pos, &index);
+
+        remove_element(ulist, &chunk, &index);
+        return 0;
+}
+
+int ulist_clear(struct ulist *ulist)
+{
+        if (!ulist)
+                return -EINVAL;
+
+        clear_ulist(ulist);
+        return 0;
+}
+
+ssize_t ulist_len(const struct ulist *ulist)
+{
+        if (!ulist)
+                return -EINVAL;
+
+        return (ssize_t)ulist->len;
+}
+
+void *ulist_at(const struct ulist *ulist, unsigned int pos)
+{
+        if (!ulist || pos >= ulist->len)
+                return NULL;
+
+        size_t index;
+        struct chunk *chunk = find_chunk(ulist, pos, &index);
+
+        return element(ulist, chunk, index);
+}
+
+/* Iterator API --------------------------------------------------------------*/
+
+static struct iterator_callbacks ulist_it_cbs;
+static struct iterator_callbacks ulist_rit_cbs;
+
+/* Utility functions -----------------*/
+
+static struct ulist_it *ulist_it_create(
+                const struct ulist *ulist,
+                struct chunk *chunk,
+                size_t index,
+                const struct iterator_callbacks *cbs)
+{
+        struct ulist_it *u_it =
+                        allocator_calloc(ulist->allocator, sizeof(*u_it));
+        if (!u_it)
+                return NULL;
+
+        it_init(&u_it->it, cbs);
+        u_it->allocator = ulist->allocator;
+        u_it->ulist = ulist;
+        u_it->chunk = chunk;
+        u_it->index = index;
+
+        return u_it;
+}
+
+/**
+ * @brief Moves 'u_it' 'offset' elements forward, skipping whole chunks.
+ */
+static void ulist_it_forward(struct ulist_it *u_it, size_t offset)
+{
+        while (offset > 0) {
+                const size_t left = u_it->chunk->len - u_it->index;
+                if (offset < left) {
+                        u_it->index += offset;
+                        return;
+                }
+
+                /* The base chunk is empty but still takes one step */
+                offset -= (left > 0 ? left : 1);
+                u_it->chunk = u_it->chunk->next;
+                u_it->index = 0;
+        }
+}
+
+/**
+ * @brief Moves 'u_it' 'offset' elements backward, skipping whole chunks.
+ */
+static void ulist_it_backward(struct ulist_it *u_it, size_t offset)
+{
+        while (offset > 0) {
+                if (offset <= u_it->index) {
+                        u_it->index -= offset;
+                        return;
+                }
+
+                offset -= u_it->index + 1;
+                u_it->chunk = u_it->chunk->previous;
+                u_it->index = (u_it->chunk->len > 0 ? u_it->chunk->len - 1 : 0);
+        }
+}
+
+/* Iterator implementation -----------*/
+
+static int ulist_it_next(struct iterator *it)
+{
+        ulist_it_forward((struct ulist_it *)it, 1);
+        return 0;
+}
+
+static int ulist_it_previous(struct iterator *it)
+{
+        ulist_it_backward((struct ulist_it *)it, 1);
+        return 0;
+}
+
+static bool ulist_it_is_valid(const struct iterator *it)
+{
+        const struct ulist_it *u_it = (const struct ulist_it *)it;
+        return (u_it->chunk != &u_it->ulist->base_chunk);
+}
+
+static void *ulist_it_data(const struct iterator *it)
+{
+        if (!ulist_it_is_valid(it))
+                return NULL;
+
+        const struct ulist_it *u_it = (const struct ulist_it *)it;
+        return element(u_it->ulist, u_it->chunk, u_it->index);
+}
+
+static const struct type_info *ulist_it_type(const struct iterator *it)
+{
+        const struct ulist_it *u_it = (const struct ulist_it *)it;
+        return u_it->ulist->type;
+}
+
+static int ulist_it_remove(struct iterator *it)
+{
+        if (!ulist_it_is_valid(it))
+                return -EINVAL;
+
+        struct ulist_it *u_it = (struct ulist_it *)it;
+        remove_element((struct ulist *)u_it->ulist, &u_it->chunk,
+                        &u_it->index);
+
+        return 0;
+}
+
+static int ulist_rit_remove(struct iterator *it)
+{
+        if (!ulist_it_is_valid(it))
+                return -EINVAL;
+
+        struct ulist_it *u_it = (struct ulist_it *)it;
+        struct chunk *chunk = u_it->chunk;
+        size_t index = u_it->index;
+
+        /*
+         * Removals only move the elements of 'chunk' and merge the chunk
+         * following it, so the previous element keeps its position.
+         */
+        ulist_it_backward(u_it, 1);
+        remove_element((struct ulist *)u_it->ulist, &chunk, &index);
+
+        return 0;
+}
+
+static int ulist_it_advance(struct iterator *it, ssize_t offset)
+{
+        struct ulist_it *u_it = (struct ulist_it *)it;
+
+        if (offset >= 0)
+                ulist_it_forward(u_it, (size_t)offset);
+        else
+                ulist_it_backward(u_it, -(size_t)offset);
+
+        return 0;
+}
+
+static int ulist_rit_advance(struct iterator *it, ssize_t offset)
+{
+        struct ulist_it *u_it = (struct ulist_it *)it;
+
+        if (offset >= 0)
+                ulist_it_backward(u_it, (size_t)offset);
+        else
+                ulist_it_forward(u_it, -(size_t)offset);
+
+        return 0;
+}
+
+static struct iterator *ulist_it_dup(const struct iterator *it)
+{
+        if (!ulist_it_is_valid(it))
+                return NULL;
+
+        const struct ulist_it *u_it = (const struct ulist_it *)it;
+        struct ulist_it *dup = ulist_it_create(
+                        u_it->ulist, u_it->chunk, u_it->index, u_it->it.cbs);
+        return (struct iterator *)dup;
+}
+
+static int ulist_it_copy(struct iterator *dest, const struct iterator *src)
+{
+        if (!ulist_it_is_valid(dest) || !ulist_it_is_valid(src))
+                return -EINVAL;
+
+        struct ulist_it *u_dest = (struct ulist_it *)dest;
+        const struct ulist_it *u_src = (const struct ulist_it *)src;
+
+        if (u_dest->ulist != u_src->ulist)
+                return -EINVAL;
+
+        u_dest->chunk = u_src->chunk;
+        u_dest->index = u_src->index;
+        return 0;
+}
+
+static void ulist_it_destroy(const struct iterator *it)
+{
+        struct ulist_it *u_it = (struct ulist_it *)it;
+        allocator_free(u_it->allocator, u_it, sizeof(*u_it));
+}
+
+static struct iterator_callbacks ulist_it_cbs = {
+        .next_cb = ulist_it_next,
+        .previous_cb = ulist_it_previous,
+        .is_valid_cb = ulist_it_is_valid,
+        .data_cb = ulist_it_data,
+        .type_cb = ulist_it_type,
+        .remove_cb = ulist_it_remove,
+        .dup_cb = ulist_it_dup,
+        .copy_cb = ulist_it_copy,
+        .destroy_cb = ulist_it_destroy,
+        .advance_cb = ulist_it_advance
+};
+
+static struct iterator_callbacks ulist_rit_cbs = {
+        .next_cb = ulist_it_previous,
+        .previous_cb = ulist_it_next,
+        .is_valid_cb = ulist_it_is_valid,
+        .data_cb = ulist_it_data,
+        .type_cb = ulist_it_type,
+        .remove_cb = ulist_rit_remove,
+        .dup_cb = ulist_it_dup,
+        .copy_cb = ulist_it_copy,
+        .destroy_cb = ulist_it_destroy,
+        .advance_cb = ulist_rit_advance
+};
+
+/* Public API ------------------------*/
+
+static struct iterator *first_it(
+                const struct ulist *ulist, const struct iterator_callbacks *cbs)
+{
+        struct ulist_it *u_it =
+                        ulist_it_create(ulist, ulist->base_chunk.next, 0, cbs);
+        return (struct iterator *)u_it;
+}
+
+static struct iterator *last_it(
+                const struct ulist *ulist, const struct iterator_callbacks *cbs)
+{
+        struct chunk *chunk = ulist->base_chunk.previous;
+        const size_t index = (chunk->len > 0 ? chunk->len - 1 : 0);
+
+        struct ulist_it *u_it = ulist_it_create(ulist, chunk, index, cbs);
+        return (struct iterator *)u_it;
+}
+
+struct iterator *ulist_begin(const struct ulist *ulist)
+{
+        if (!ulist)
+                return NULL;
+
+        return first_it(ulist, &ulist_it_cbs);
+}
+
+struct iterator *ulist_end(const struct ulist *ulist)
+{
+        if (!ulist)
+                return NULL;
+
+        return last_it(ulist, &ulist_it_cbs);
+}
+
+struct iterator *ulist_rbegin(const struct ulist *ulist)
+{
+        if (!ulist)
+                return NULL;
+
+        return last_it(ulist, &ulist_rit_cbs);
+}
+
+struct iterator *ulist_rend(const struct ulist *ulist)
+{
+        if (!ulist)
+                return NULL;
+
+        return first_it(ulist, &ulist_rit_cbs);
+}
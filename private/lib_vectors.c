@@ -5,23 +5,50 @@
 
 /* Includes ------------------------------------------------------------------*/
 
+#define _GNU_SOURCE /* mremap() */
+
+#include "lib_allocators_private.h"
 #include "lib_iterators_private.h"
+#include "lib_searches.h"
+#include "lib_sorts.h"
 #include "lib_vectors.h"
 
 #include <errno.h>
+#include <stdalign.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 
 /* Definitions ---------------------------------------------------------------*/
 
+#define DEFAULT_ALIGNMENT alignof(max_align_t) /* Guaranteed by allocators */
+#define HUGE_ALIGNMENT 64 /* Cache line */
+#define HUGE_PAGE_SIZE ((size_t)2 << 20)
+
+enum meta_storage {
+        META_STORAGE_HEAP, /* Allocated by the library */
+        META_STORAGE_INLINE, /* Provided by the caller, never freed */
+        META_STORAGE_HUGE /* Mapped by the library, backed by huge pages */
+};
+
 struct meta {
+        void *base; /* Start of the storage, the meta is placed at its end */
+        size_t size; /* Bytes of storage from 'base' */
+        size_t alignment; /* Of the elements */
+        enum meta_storage storage;
+        const struct allocator *allocator; /* Of heap storages */
         const struct type_info *type;
         size_t len;
         size_t capacity;
 };
 
+_Static_assert(sizeof(struct meta) <= VECTOR_STORAGE_HEADER,
+                "VECTOR_STORAGE_HEADER is too small to hold a vector header");
+
 struct vector_it {
         struct iterator it; /* Placed at top for inheritance */
+        const struct allocator *allocator; /* May outlive 'meta' */
         struct meta *meta;
         int pos;
 };
@@ -44,10 +71,196 @@ static void *meta_to_vector(const struct meta *meta)
                 : NULL;
 }
 
+/* Storage functions -----------------*/
+
+static size_t round_up(size_t value, size_t multiple)
+{
+        return (value + multiple - 1) / multiple * multiple;
+}
+
+/**
+ * @brief Returns the greatest offset of the elements from the start of a
+ * storage aligned on DEFAULT_ALIGNMENT, when they are aligned on 'alignment'.
+ */
+static size_t elements_offset(size_t alignment)
+{
+        return round_up(sizeof(struct meta), DEFAULT_ALIGNMENT)
+                        + alignment - DEFAULT_ALIGNMENT;
+}
+
+/**
+ * @brief Returns the meta of the storage starting at 'base', placed right
+ * before its first element aligned on 'alignment'.
+ */
+static struct meta *meta_at(void *base, size_t alignment)
+{
+        const uintptr_t elements = round_up(
+                        (uintptr_t)base + sizeof(struct meta), alignment);
+        return (struct meta *)elements - 1;
+}
+
+/**
+ * @brief Updates the storage of 'meta' to 'base', of 'size' bytes, and its
+ * capacity accordingly.
+ */
+static void set_storage(struct meta *meta, void *base, size_t size)
+{
+        const char *end = (char *)base + size;
+
+        meta->base = base;
+        meta->size = size;
+        meta->capacity = (end - (char *)meta_to_vector(meta))
+                        / meta->type->size;
+}
+
+/**
+ * @brief Places the meta of an empty vector of 'type' in 'base', a storage of
+ * 'size' bytes.
+ *
+ * @return Pointer to the meta.
+ */
+static struct meta *place_meta(
+                void *base,
+                size_t size,
+                size_t alignment,
+                enum meta_storage storage,
+                const struct allocator *allocator,
+                const struct type_info *type)
+{
+        struct meta *meta = meta_at(base, alignment);
+
+        *meta = (struct meta) {
+                .alignment = alignment,
+                .storage = storage,
+                .allocator = allocator,
+                .type = type,
+                .len = 0
+        };
+
+        set_storage(meta, base, size);
+        return meta;
+}
+
+/**
+ * @brief Allocates the storage of an empty vector of 'type' able to hold at
+ * least 'capacity' elements aligned on 'alignment'. Heap storages come from
+ * 'allocator', huge storages are rounded up to a whole number of huge pages,
+ * the extra space adding to the capacity.
+ *
+ * @return Pointer to the meta of the new storage on success.
+ * @return NULL on failure.
+ */
+static struct meta *alloc_meta(
+                const struct type_info *type,
+                size_t capacity,
+                size_t alignment,
+                enum meta_storage storage,
+                const struct allocator *allocator)
+{
+        size_t size = elements_offset(alignment) + capacity * type->size;
+        void *base;
+
+        if (storage == META_STORAGE_HUGE) {
+                size = round_up(size, HUGE_PAGE_SIZE);
+                base = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (base == MAP_FAILED)
+                        return NULL;
+
+#ifdef MADV_HUGEPAGE
+                /* Only a hint, the mapping works with regular pages too */
+                madvise(base, size, MADV_HUGEPAGE);
+#endif
+        } else {
+                base = allocator->alloc(size, allocator->ctx);
+                if (!base)
+                        return NULL;
+        }
+
+        return place_meta(base, size, alignment, storage, allocator, type);
+}
+
+static void free_meta(struct meta *meta)
+{
+        if (meta->storage == META_STORAGE_HEAP)
+                allocator_free(meta->allocator, meta->base, meta->size);
+        else if (meta->storage == META_STORAGE_HUGE)
+                munmap(meta->base, meta->size);
+}
+
+/**
+ * @brief Resizes the storage of 'meta' in place, or moves it, to hold
+ * 'capacity' elements when the system or the allocator can do so without
+ * copying them. The offset of the elements from the start of the storage
+ * MUST not change, which rules out over-aligned heap storages.
+ *
+ * @return Pointer to the resized meta on success.
+ * @return NULL if the storage could not be resized this way, in which case
+ * 'meta' is left untouched.
+ */
+static struct meta *resize_meta(struct meta *meta, size_t capacity)
+{
+        const struct allocator *allocator = meta->allocator;
+        const size_t alignment = meta->alignment;
+        size_t size = elements_offset(alignment) + capacity * meta->type->size;
+        void *base;
+
+        if (meta->storage == META_STORAGE_HUGE) {
+#ifdef MREMAP_MAYMOVE
+                size = round_up(size, HUGE_PAGE_SIZE);
+                base = mremap(meta->base, meta->size, size, MREMAP_MAYMOVE);
+                if (base == MAP_FAILED)
+                        return NULL;
+#else
+                return NULL;
+#endif
+        } else if (meta->storage == META_STORAGE_HEAP && allocator->realloc
+                        && alignment == DEFAULT_ALIGNMENT) {
+                base = allocator->realloc(meta->base, meta->size, size,
+                                allocator->ctx);
+                if (!base)
+                        return NULL;
+        } else {
+                return NULL;
+        }
+
+        meta = meta_at(base, alignment);
+        set_storage(meta, base, size);
+
+        return meta;
+}
+
+/**
+ * @brief Moves the elements of 'meta' to a new storage of 'storage' able to
+ * hold 'capacity' elements, and frees the old one.
+ *
+ * @return Pointer to the new meta on success.
+ * @return NULL on failure, in which case 'meta' is left untouched.
+ */
+static struct meta *move_meta(
+                struct meta *meta,
+                size_t capacity,
+                enum meta_storage storage)
+{
+        struct meta *new_meta = alloc_meta(meta->type, capacity,
+                        meta->alignment, storage, meta->allocator);
+        if (!new_meta)
+                return NULL;
+
+        memcpy(meta_to_vector(new_meta), meta_to_vector(meta),
+                        meta->len * meta->type->size);
+        new_meta->len = meta->len;
+
+        free_meta(meta);
+        return new_meta;
+}
+
 /* Private utility functions ---------*/
 
 /**
- * @brief Sets the capacity of 'meta' to 'capacity'.
+ * @brief Sets the capacity of 'meta' to 'capacity'. Inline storages are never
+ * shrunk and move to the heap when they grow. Huge storages keep a whole
+ * number of huge pages, their capacity may end up greater than 'capacity'.
  *
  * @return Pointer to a valid meta, reallocated or not.
  *
@@ -61,14 +274,25 @@ static struct meta *set_capacity(struct meta *meta, size_t capacity, int *ret)
         struct meta *new_meta;
         int res;
 
-        new_meta = realloc(meta, sizeof(*meta) + meta->type->size * capacity);
+        if (meta->storage == META_STORAGE_INLINE) {
+                if (capacity <= meta->capacity) {
+                        res = 0;
+                        goto error_realloc;
+                }
+
+                new_meta = move_meta(meta, capacity, META_STORAGE_HEAP);
+        } else {
+                new_meta = resize_meta(meta, capacity);
+                if (!new_meta)
+                        new_meta = move_meta(meta, capacity, meta->storage);
+        }
+
         if (!new_meta) {
                 res = -ENOMEM;
                 goto error_realloc;
         }
 
         meta = new_meta;
-        meta->capacity = capacity;
         res = 0;
 error_realloc:
         if (ret)
@@ -169,21 +393,98 @@ static void destroy_values(const struct meta *meta)
 
 /* API -----------------------------------------------------------------------*/
 
-void *vector_create(const struct type_info *type, size_t count)
+/**
+ * @brief Creates a vector of 'count' zeroed elements of 'type', stored in a
+ * new storage of 'storage' with elements aligned on 'alignment'.
+ *
+ * @return Pointer to the new vector on success.
+ * @return NULL if 'type' is invalid or on failure.
+ */
+static void *create(
+                const struct type_info *type,
+                size_t count,
+                size_t alignment,
+                enum meta_storage storage,
+                const struct allocator *allocator)
 {
-        if (!type)
+        if (!type || !allocator_is_valid(allocator))
                 return NULL;
 
         if (type->size == 0 || !type->copy || !type->comp || !type->destroy)
                 return NULL;
 
-        struct meta *meta = calloc(1, sizeof(*meta) + count * type->size);
+        struct meta *meta = alloc_meta(type, count, alignment, storage,
+                        allocator);
         if (!meta)
                 return NULL;
 
-        meta->type = type;
         meta->len = count;
-        meta->capacity = count;
+        memset(meta_to_vector(meta), 0, count * type->size);
+
+        return meta_to_vector(meta);
+}
+
+void *vector_create(const struct type_info *type, size_t count)
+{
+        return create(type, count, DEFAULT_ALIGNMENT, META_STORAGE_HEAP,
+                        allocator_default());
+}
+
+void *vector_create_with(
+                const struct type_info *type,
+                size_t count,
+                const struct allocator *allocator)
+{
+        return create(type, count, DEFAULT_ALIGNMENT, META_STORAGE_HEAP,
+                        allocator);
+}
+
+void *vector_create_aligned(
+                const struct type_info *type,
+                size_t count,
+                size_t alignment)
+{
+        /* Powers of 2 only */
+        if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+                return NULL;
+
+        if (alignment < DEFAULT_ALIGNMENT)
+                alignment = DEFAULT_ALIGNMENT;
+
+        return create(type, count, alignment, META_STORAGE_HEAP,
+                        allocator_default());
+}
+
+void *vector_create_huge(const struct type_info *type, size_t count)
+{
+        return create(type, count, HUGE_ALIGNMENT, META_STORAGE_HUGE,
+                        allocator_default());
+}
+
+void *vector_create_small(
+                const struct type_info *type,
+                size_t count,
+                void *storage,
+                size_t storage_size)
+{
+        if (!type || !storage || storage_size < VECTOR_STORAGE_HEADER)
+                return NULL;
+
+        /* Otherwise the elements could start past the end of 'storage' */
+        if ((uintptr_t)storage % DEFAULT_ALIGNMENT != 0)
+                return NULL;
+
+        if (type->size == 0 || !type->copy || !type->comp || !type->destroy)
+                return NULL;
+
+        struct meta *meta = place_meta(storage, storage_size,
+                        DEFAULT_ALIGNMENT, META_STORAGE_INLINE,
+                        allocator_default(), type);
+        if (meta->capacity < count)
+                return vector_create(type, count);
+
+        meta->len = count;
+        memset(meta_to_vector(meta), 0, count * type->size);
 
         return meta_to_vector(meta);
 }
@@ -195,7 +496,13 @@ void vector_destroy(const void *vector)
                 return;
 
         destroy_values(meta);
-        free(meta);
+        free_meta(meta);
+}
+
+bool vector_is_inline(const void *vector)
+{
+        const struct meta *meta = vector_to_meta(vector);
+        return (meta && meta->storage == META_STORAGE_INLINE);
 }
 
 void *vector_push(void *vector, const void *data, int *ret)
@@ -280,7 +587,7 @@ int vector_sort(void *vector)
         if (!meta)
                 return -EINVAL;
 
-        qsort(vector, meta->len, meta->type->size, meta->type->comp);
+        sort_typed(vector, meta->len, meta->type);
         return 0;
 }
 
@@ -294,6 +601,126 @@ int vector_sort_by(void *vector, type_comp_cb comp)
         return 0;
 }
 
+int vector_stable_sort(void *vector)
+{
+        const struct meta *meta = vector_to_meta(vector);
+        if (!meta)
+                return -EINVAL;
+
+        return sort_stable(vector, meta->len, meta->type->size,
+                        meta->type->comp);
+}
+
+int vector_stable_sort_by(void *vector, type_comp_cb comp)
+{
+        const struct meta *meta = vector_to_meta(vector);
+        if (!meta || !comp)
+                return -EINVAL;
+
+        return sort_stable(vector, meta->len, meta->type->size, comp);
+}
+
+int vector_partial_sort(void *vector, size_t k)
+{
+        const struct meta *meta = vector_to_meta(vector);
+        if (!meta)
+                return -EINVAL;
+
+        if (meta->len < k)
+                return -ERANGE;
+
+        sort_partial(vector, meta->len, meta->type->size, meta->type->comp, k);
+        return 0;
+}
+
+int vector_nth_element(void *vector, size_t k)
+{
+        const struct meta *meta = vector_to_meta(vector);
+        if (!meta)
+                return -EINVAL;
+
+        if (meta->len <= k)
+                return -ERANGE;
+
+        sort_select(vector, meta->len, meta->type->size, meta->type->comp, k);
+        return 0;
+}
+
+int vector_par_sort(void *vector, bool stable)
+{
+        const struct meta *meta = vector_to_meta(vector);
+        if (!meta)
+                return -EINVAL;
+
+        return sort_parallel(vector, meta->len, meta->type->size,
+                        meta->type->comp, stable);
+}
+
+ssize_t vector_lower_bound(const void *vector, const void *value)
+{
+        const struct meta *meta = vector_to_meta(vector);
+        if (!meta || !value)
+                return -EINVAL;
+
+        const struct type_info *type = meta->type;
+        const size_t len = meta->len;
+        const char *data = vector;
+
+        return (ssize_t)search_lower_bound(data, len, type->size, type->comp,
+                        value);
+}
+
+ssize_t vector_upper_bound(const void *vector, const void *value)
+{
+        const struct meta *meta = vector_to_meta(vector);
+        if (!meta || !value)
+                return -EINVAL;
+
+        const struct type_info *type = meta->type;
+        const size_t len = meta->len;
+        const char *data = vector;
+
+        return (ssize_t)search_upper_bound(data, len, type->size, type->comp,
+                        value);
+}
+
+bool vector_binary_search(const void *vector, const void *value)
+{
+        const struct meta *meta = vector_to_meta(vector);
+        if (!meta || !value)
+                return false;
+
+        const struct type_info *type = meta->type;
+        const size_t len = meta->len;
+        const char *data = vector;
+
+        const size_t pos = search_lower_bound(data, len, type->size,
+                        type->comp, value);
+
+        return (pos < len && type->comp(data + pos * type->size, value) == 0);
+}
+
+int vector_equal_range(
+                const void *vector,
+                const void *value,
+                size_t *first,
+                size_t *last)
+{
+        const struct meta *meta = vector_to_meta(vector);
+        if (!meta || !value || !first || !last)
+                return -EINVAL;
+
+        const struct type_info *type = meta->type;
+        const size_t len = meta->len;
+        const char *data = vector;
+
+        *first = search_lower_bound(data, len, type->size, type->comp, value);
+        *last = *first + search_upper_bound(data + *first * type->size,
+                        len - *first, type->size, type->comp, value);
+
+        return 0;
+}
+
 int vector_clear(void *vector)
 {
         struct meta *meta = vector_to_meta(vector);
@@ -391,11 +818,13 @@ static struct vector_it *vector_it_create(
                 int pos,
                 const struct iterator_callbacks *cbs)
 {
-        struct vector_it *v_it = calloc(1, sizeof(*v_it));
+        struct vector_it *v_it = allocator_calloc(meta->allocator,
+                        sizeof(*v_it));
         if (!v_it)
                 return NULL;
 
         it_init(&v_it->it, cbs);
+        v_it->allocator = meta->allocator;
         v_it->meta = meta;
         v_it->pos = pos;
 
@@ -488,10 +917,34 @@ static int vector_it_copy(struct iterator *dest, const struct iterator *src)
         return 0;
 }
 
+static ssize_t vector_it_span(const struct iterator *it, void **data)
+{
+        if (!vector_it_is_valid(it))
+                return -EINVAL;
+
+        const struct vector_it *v_it = (const struct vector_it *)it;
+        *data = data_offset(v_it->meta, v_it->pos);
+        return (ssize_t)(v_it->meta->len - v_it->pos);
+}
+
+static int vector_it_advance(struct iterator *it, ssize_t offset)
+{
+        struct vector_it *v_it = (struct vector_it *)it;
+        v_it->pos += offset;
+        return 0;
+}
+
+static int vector_rit_advance(struct iterator *it, ssize_t offset)
+{
+        struct vector_it *v_it = (struct vector_it *)it;
+        v_it->pos -= offset;
+        return 0;
+}
+
 static void vector_it_destroy(const struct iterator *it)
 {
         struct vector_it *v_it = (struct vector_it *)it;
-        free(v_it);
+        allocator_free(v_it->allocator, v_it, sizeof(*v_it));
 }
 
 static struct iterator_callbacks vector_it_cbs = {
@@ -503,7 +956,9 @@ static struct iterator_callbacks vector_it_cbs = {
         .remove_cb = vector_it_remove,
         .dup_cb = vector_it_dup,
         .copy_cb = vector_it_copy,
-        .destroy_cb = vector_it_destroy
+        .destroy_cb = vector_it_destroy,
+        .span_cb = vector_it_span,
+        .advance_cb = vector_it_advance
 };
 
 static struct iterator_callbacks vector_rit_cbs = {
@@ -515,7 +970,9 @@ static struct iterator_callbacks vector_rit_cbs = {
         .remove_cb = vector_rit_remove,
         .dup_cb = vector_it_dup,
         .copy_cb = vector_it_copy,
-        .destroy_cb = vector_it_destroy
+        .destroy_cb = vector_it_destroy,
+        .span_cb = NULL,
+        .advance_cb = vector_rit_advance
 };
 
 /* Public API ------------------------*/
@@ -0,0 +1,132 @@
+/**
+ * @author Maxence ROBIN
+ * @brief Provides futex based waits for the lock-free containers.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_waits.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/* Definitions ---------------------------------------------------------------*/
+
+#define NSEC_PER_SEC 1000000000L
+#define NSEC_PER_MSEC 1000000L
+
+/* Static functions ----------------------------------------------------------*/
+
+static long futex(
+                atomic_uint *address,
+                int op,
+                unsigned int value,
+                const struct timespec *timeout)
+{
+        return syscall(SYS_futex, address, op, value, timeout, NULL, 0);
+}
+
+/**
+ * @brief Sets 'remaining' to the time left until 'deadline'.
+ *
+ * @return 0 on success.
+ * @return -ETIMEDOUT if 'deadline' is already reached.
+ */
+static int time_left(
+                const struct timespec *deadline, struct timespec *remaining)
+{
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+
+        remaining->tv_sec = deadline->tv_sec - now.tv_sec;
+        remaining->tv_nsec = deadline->tv_nsec - now.tv_nsec;
+
+        if (remaining->tv_nsec < 0) {
+                remaining->tv_nsec += NSEC_PER_SEC;
+                --remaining->tv_sec;
+        }
+
+        if (remaining->tv_sec < 0)
+                return -ETIMEDOUT;
+
+        return 0;
+}
+
+/* API -----------------------------------------------------------------------*/
+
+void wait_event_init(struct wait_event *event)
+{
+        atomic_init(&event->sequence, 0);
+        atomic_init(&event->waiters, 0);
+}
+
+void wait_deadline(struct timespec *deadline, int timeout)
+{
+        if (timeout < 0) {
+                deadline->tv_sec = -1;
+                deadline->tv_nsec = 0;
+                return;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, deadline);
+        deadline->tv_sec += timeout / 1000;
+        deadline->tv_nsec += (timeout % 1000) * NSEC_PER_MSEC;
+
+        if (deadline->tv_nsec >= NSEC_PER_SEC) {
+                deadline->tv_nsec -= NSEC_PER_SEC;
+                ++deadline->tv_sec;
+        }
+}
+
+unsigned int wait_event_prepare(struct wait_event *event)
+{
+        const unsigned int key = atomic_load(&event->sequence);
+
+        /* Orders the registration before the check of the condition */
+        atomic_fetch_add(&event->waiters, 1);
+        atomic_thread_fence(memory_order_seq_cst);
+
+        return key;
+}
+
+void wait_event_cancel(struct wait_event *event)
+{
+        atomic_fetch_sub_explicit(&event->waiters, 1, memory_order_relaxed);
+}
+
+int wait_event_wait(
+                struct wait_event *event,
+                unsigned int key,
+                const struct timespec *deadline)
+{
+        struct timespec remaining;
+        const struct timespec *timeout = NULL;
+        int ret = 0;
+
+        if (deadline->tv_sec >= 0) {
+                ret = time_left(deadline, &remaining);
+                timeout = &remaining;
+        }
+
+        if (ret == 0 && futex(&event->sequence, FUTEX_WAIT_PRIVATE, key,
+                        timeout) < 0 && errno == ETIMEDOUT)
+                ret = -ETIMEDOUT;
+
+        wait_event_cancel(event);
+        return ret;
+}
+
+void wait_event_notify(struct wait_event *event)
+{
+        /* Orders the publication of the condition before the check */
+        atomic_thread_fence(memory_order_seq_cst);
+
+        if (atomic_load_explicit(&event->waiters, memory_order_relaxed) == 0)
+                return;
+
+        atomic_fetch_add(&event->sequence, 1);
+        futex(&event->sequence, FUTEX_WAKE_PRIVATE, INT_MAX, NULL);
+}
@@ -0,0 +1,79 @@
+/**
+ * @author Maxence ROBIN
+ * @brief Provides futex based waits for the lock-free containers.
+ */
+
+#ifndef LIB_WAITS_H
+#define LIB_WAITS_H
+
+/* Includes ------------------------------------------------------------------*/
+
+#include <stdatomic.h>
+#include <time.h>
+
+/* Definitions ---------------------------------------------------------------*/
+
+/**
+ * @brief Event threads wait for until a condition they checked changes.
+ * 'sequence' changes on every notification, 'waiters' counts the threads about
+ * to wait or waiting, so that notifications are free while it is 0.
+ *
+ * A waiting thread MUST follow this pattern, the condition being re-checked
+ * after wait_event_prepare() so that no notification is missed :
+ *      key = wait_event_prepare(event);
+ *      if (condition)
+ *              wait_event_cancel(event);
+ *      else
+ *              wait_event_wait(event, key, deadline);
+ */
+struct wait_event {
+        atomic_uint sequence;
+        atomic_uint waiters;
+};
+
+/* API -----------------------------------------------------------------------*/
+
+/**
+ * @brief Initializes 'event'.
+ */
+void wait_event_init(struct wait_event *event);
+
+/**
+ * @brief Sets 'deadline' to 'timeout' milliseconds from now. If 'timeout' is
+ * negative, there is no deadline.
+ */
+void wait_deadline(struct timespec *deadline, int timeout);
+
+/**
+ * @brief Registers the calling thread as a waiter of 'event'.
+ *
+ * @return The key to give to wait_event_wait().
+ */
+unsigned int wait_event_prepare(struct wait_event *event);
+
+/**
+ * @brief Unregisters the calling thread as a waiter of 'event' without
+ * waiting.
+ */
+void wait_event_cancel(struct wait_event *event);
+
+/**
+ * @brief Waits until 'event' is notified after wait_event_prepare() returned
+ * 'key', or until 'deadline' if it is set, then unregisters the calling thread
+ * as a waiter. Spurious wakeups may happen.
+ *
+ * @return 0 on success.
+ * @return -ETIMEDOUT if 'deadline' is reached.
+ */
+int wait_event_wait(
+                struct wait_event *event,
+                unsigned int key,
+                const struct timespec *deadline);
+
+/**
+ * @brief Wakes the threads waiting for 'event', if any. MUST be called after
+ * the change of condition is published.
+ */
+void wait_event_notify(struct wait_event *event);
+
+#endif /* LIB_WAITS_H */
@@ -0,0 +1,454 @@
+/**
+ * @author Maxence ROBIN
+ * @brief Provides circular buffers keeping aggregates of their values
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_allocators_private.h"
+#include "lib_window_buffers.h"
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Definitions ---------------------------------------------------------------*/
+
+enum number_kind {
+        NUMBER_NONE,
+        NUMBER_SIGNED,
+        NUMBER_UNSIGNED,
+        NUMBER_FLOATING
+};
+
+/*
+ * Monotonic deque of slots, in order of insertion. A value is only kept while
+ * no newer value is lower, or greater for the maximum, so that the front of the
+ * deque always holds the extremum of the window.
+ */
+struct deque {
+        size_t *slots;
+        size_t first;
+        size_t len;
+};
+
+/*
+ * Values and deques are stored right after the buffer :
+ * | struct window_buffer | min slots | max slots | values |
+ */
+struct window_buffer {
+        const struct allocator *allocator;
+        const struct type_info *type;
+        size_t count;
+        size_t len;
+        size_t write; /* Slot of the next value, the oldest one once full */
+        enum number_kind kind;
+        union {
+                unsigned long long integer; /* Of signed ones too */
+                long double floating;
+        } sum;
+        struct deque min;
+        struct deque max;
+        char *data;
+};
+
+/* Static functions ----------------------------------------------------------*/
+
+static char *data_offset(const struct window_buffer *buffer, size_t slot)
+{
+        return buffer->data + buffer->type->size * slot;
+}
+
+static size_t alloc_size(const struct window_buffer *buffer)
+{
+        return sizeof(*buffer) + buffer->count
+                        * (2 * sizeof(size_t) + buffer->type->size);
+}
+
+/**
+ * @brief Returns the slot 'offset' slots after 'slot', wrapping around the end
+ * of 'buffer'.
+ *
+ * @note 'offset' MUST not be greater than the number of elements of 'buffer'.
+ */
+static size_t wrap(
+                const struct window_buffer *buffer, size_t slot, size_t offset)
+{
+        const size_t next = slot + offset;
+        return (next >= buffer->count ? next - buffer->count : next);
+}
+
+static size_t oldest(const struct window_buffer *buffer)
+{
+        return wrap(buffer, buffer->write, buffer->count - buffer->len);
+}
+
+/* Numbers functions -----------------*/
+
+static enum number_kind number_kind(const struct type_info *type)
+{
+        if (type == type_char() || type == type_short() || type == type_int()
+                        || type == type_long() || type == type_long_long())
+                return NUMBER_SIGNED;
+
+        if (type == type_uchar() || type == type_ushort()
+                        || type == type_uint() || type == type_ulong()
+                        || type == type_ulong_long())
+                return NUMBER_UNSIGNED;
+
+        if (type == type_float() || type == type_double()
+                        || type == type_long_double())
+                return NUMBER_FLOATING;
+
+        return NUMBER_NONE;
+}
+
+static long long signed_value(const struct type_info *type, const void *value)
+{
+        if (type == type_char())
+                return *(const char *)value;
+
+        if (type == type_short())
+                return *(const short *)value;
+
+        if (type == type_int())
+                return *(const int *)value;
+
+        if (type == type_long())
+                return *(const long *)value;
+
+        return *(const long long *)value;
+}
+
+static unsigned long long unsigned_value(
+                const struct type_info *type, const void *value)
+{
+        if (type == type_uchar())
+                return *(const unsigned char *)value;
+
+        if (type == type_ushort())
+                return *(const unsigned short *)value;
+
+        if (type == type_uint())
+                return *(const unsigned int *)value;
+
+        if (type == type_ulong())
+                return *(const unsigned long *)value;
+
+        return *(const unsigned long long *)value;
+}
+
+static long double floating_value(
+                const struct type_info *type, const void *value)
+{
+        if (type == type_float())
+                return *(const float *)value;
+
+        if (type == type_double())
+                return *(const double *)value;
+
+        return *(const long double *)value;
+}
+
+/**
+ * @brief Adds the value at 'slot' to the sum of 'buffer', or subtracts it if
+ * 'add' is false. Signed sums are computed as unsigned to wrap without
+ * undefined behavior, values added then subtracted cancelling out exactly.
+ */
+static void sum_value(struct window_buffer *buffer, size_t slot, bool add)
+{
+        const void *value = data_offset(buffer, slot);
+
+        switch (buffer->kind) {
+        case NUMBER_SIGNED:
+        case NUMBER_UNSIGNED: {
+                const unsigned long long number = (buffer->kind == NUMBER_SIGNED
+                                ? (unsigned long long)signed_value(
+                                                buffer->type, value)
+                                : unsigned_value(buffer->type, value));
+
+                if (add)
+                        buffer->sum.integer += number;
+                else
+                        buffer->sum.integer -= number;
+
+                break;
+        }
+        case NUMBER_FLOATING: {
+                const long double number = floating_value(buffer->type, value);
+
+                if (add)
+                        buffer->sum.floating += number;
+                else
+                        buffer->sum.floating -= number;
+
+                break;
+        }
+        default:
+                break;
+        }
+}
+
+/**
+ * @brief Computes again the sum of floating point values of 'buffer', dropping
+ * the rounding errors accumulated by additions and subtractions.
+ */
+static void refresh_sum(struct window_buffer *buffer)
+{
+        buffer->sum.floating = 0;
+
+        size_t slot = oldest(buffer);
+        for (size_t i = 0; i < buffer->len; ++i, slot = wrap(buffer, slot, 1))
+                sum_value(buffer, slot, true);
+}
+
+/* Deques functions ------------------*/
+
+static size_t deque_at(
+                const struct window_buffer *buffer,
+                const struct deque *deque,
+                size_t pos)
+{
+        return deque->slots[wrap(buffer, deque->first, pos)];
+}
+
+/**
+ * @brief Adds 'slot' at the back of 'deque', after removing the values it
+ * makes useless : those greater or equal to its value for the minimum, and
+ * those lower or equal for the maximum.
+ */
+static void deque_push(
+                const struct window_buffer *buffer,
+                struct deque *deque,
+                size_t slot,
+                bool max)
+{
+        const void *value = data_offset(buffer, slot);
+
+        while (deque->len > 0) {
+                const size_t back = deque_at(buffer, deque, deque->len - 1);
+                const int comp = buffer->type->comp(
+                                data_offset(buffer, back), value);
+
+                if ((max && comp > 0) || (!max && comp < 0))
+                        break;
+
+                --deque->len;
+        }
+
+        deque->slots[wrap(buffer, deque->first, deque->len)] = slot;
+        ++deque->len;
+}
+
+/**
+ * @brief Removes 'slot' from the front of 'deque', if it is still there.
+ */
+static void deque_expire(
+                const struct window_buffer *buffer,
+                struct deque *deque,
+                size_t slot)
+{
+        if (deque->len == 0 || deque_at(buffer, deque, 0) != slot)
+                return;
+
+        deque->first = wrap(buffer, deque->first, 1);
+        --deque->len;
+}
+
+/* Buffer functions ------------------*/
+
+static void remove_oldest(struct window_buffer *buffer)
+{
+        const size_t slot = oldest(buffer);
+
+        deque_expire(buffer, &buffer->min, slot);
+        deque_expire(buffer, &buffer->max, slot);
+        sum_value(buffer, slot, false);
+        buffer->type->destroy(data_offset(buffer, slot));
+        --buffer->len;
+}
+
+static void destroy_values(const struct window_buffer *buffer)
+{
+        size_t slot = oldest(buffer);
+        for (size_t i = 0; i < buffer->len; ++i, slot = wrap(buffer, slot, 1))
+                buffer->type->destroy(data_offset(buffer, slot));
+}
+
+static void reset(struct window_buffer *buffer)
+{
+        buffer->len = 0;
+        buffer->write = 0;
+        memset(&buffer->sum, 0, sizeof(buffer->sum));
+        buffer->min.first = 0;
+        buffer->min.len = 0;
+        buffer->max.first = 0;
+        buffer->max.len = 0;
+}
+
+/* API -----------------------------------------------------------------------*/
+
+struct window_buffer *window_buffer_create(
+                const struct type_info *type, size_t count)
+{
+        return window_buffer_create_with(type, count, allocator_default());
+}
+
+struct window_buffer *window_buffer_create_with(
+                const struct type_info *type,
+                size_t count,
+                const struct allocator *allocator)
+{
+        if (!type || count == 0 || !allocator_is_valid(allocator))
+                return NULL;
+
+        if (type->size == 0 || !type->copy || !type->comp || !type->destroy)
+                return NULL;
+
+        if (count > (SIZE_MAX / 2) / (2 * sizeof(size_t) + type->size))
+                return NULL;
+
+        struct window_buffer *buffer = allocator_calloc(allocator,
+                        sizeof(*buffer) + count
+                                        * (2 * sizeof(size_t) + type->size));
+        if (!buffer)
+                return NULL;
+
+        buffer->allocator = allocator;
+        buffer->type = type;
+        buffer->count = count;
+        buffer->kind = number_kind(type);
+        buffer->min.slots = (size_t *)(buffer + 1);
+        buffer->max.slots = buffer->min.slots + count;
+        buffer->data = (char *)(buffer->max.slots + count);
+        reset(buffer);
+
+        return buffer;
+}
+
+void window_buffer_destroy(const struct window_buffer *buffer)
+{
+        if (!buffer)
+                return;
+
+        destroy_values(buffer);
+        allocator_free(buffer->allocator, (void *)buffer, alloc_size(buffer));
+}
+
+int window_buffer_push(struct window_buffer *buffer, const void *data)
+{
+        if (!buffer || !data)
+                return -EINVAL;
+
+        if (buffer->len == buffer->count)
+                remove_oldest(buffer);
+
+        const size_t slot = buffer->write;
+        char *dest = data_offset(buffer, slot);
+
+        /* 'copy' may free its destination */
+        memset(dest, 0, buffer->type->size);
+        buffer->type->copy(dest, data);
+
+        buffer->write = wrap(buffer, slot, 1);
+        ++buffer->len;
+
+        deque_push(buffer, &buffer->min, slot, false);
+        deque_push(buffer, &buffer->max, slot, true);
+
+        if (buffer->kind == NUMBER_FLOATING && buffer->write == 0)
+                refresh_sum(buffer);
+        else
+                sum_value(buffer, slot, true);
+
+        return 0;
+}
+
+const void *window_buffer_min(const struct window_buffer *buffer)
+{
+        if (!buffer || buffer->len == 0)
+                return NULL;
+
+        return data_offset(buffer, deque_at(buffer, &buffer->min, 0));
+}
+
+const void *window_buffer_max(const struct window_buffer *buffer)
+{
+        if (!buffer || buffer->len == 0)
+                return NULL;
+
+        return data_offset(buffer, deque_at(buffer, &buffer->max, 0));
+}
+
+int window_buffer_sum(const struct window_buffer *buffer, double *sum)
+{
+        if (!buffer || !sum)
+                return -EINVAL;
+
+        switch (buffer->kind) {
+        case NUMBER_SIGNED:
+                *sum = (double)(long long)buffer->sum.integer;
+                return 0;
+        case NUMBER_UNSIGNED:
+                *sum = (double)buffer->sum.integer;
+                return 0;
+        case NUMBER_FLOATING:
+                *sum = (double)buffer->sum.floating;
+                return 0;
+        default:
+                return -ENOTSUP;
+        }
+}
+
+int window_buffer_mean(const struct window_buffer *buffer, double *mean)
+{
+        if (!buffer || !mean)
+                return -EINVAL;
+
+        double sum;
+        const int ret = window_buffer_sum(buffer, &sum);
+        if (ret < 0)
+                return ret;
+
+        if (buffer->len == 0)
+                return -ENOMEM;
+
+        *mean = sum / (double)buffer->len;
+        return 0;
+}
+
+const void *window_buffer_at(const struct window_buffer *buffer, size_t pos)
+{
+        if (!buffer || pos >= buffer->len)
+                return NULL;
+
+        return data_offset(buffer, wrap(buffer, oldest(buffer), pos));
+}
+
+int window_buffer_clear(struct window_buffer *buffer)
+{
+        if (!buffer)
+                return -EINVAL;
+
+        destroy_values(buffer);
+        reset(buffer);
+
+        return 0;
+}
+
+ssize_t window_buffer_len(const struct window_buffer *buffer)
+{
+        if (!buffer)
+                return -EINVAL;
+
+        return (ssize_t)buffer->len;
+}
+
+ssize_t window_buffer_count(const struct window_buffer *buffer)
+{
+        if (!buffer)
+                return -EINVAL;
+
+        return (ssize_t)buffer->count;
+}
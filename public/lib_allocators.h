@@ -0,0 +1,50 @@
+/**
+ * @author Maxence ROBIN
+ * @brief Provides the allocator interface used by containers.
+ */
+
+#ifndef LIB_ALLOCATORS_H
+#define LIB_ALLOCATORS_H
+
+/* Includes ------------------------------------------------------------------*/
+
+#include <stddef.h>
+
+/* Definitions ---------------------------------------------------------------*/
+
+typedef void *(*allocator_alloc_cb)(size_t, void *);
+typedef void *(*allocator_realloc_cb)(void *, size_t, size_t, void *);
+typedef void (*allocator_free_cb)(void *, size_t, void *);
+
+/**
+ * @brief Callbacks used by containers to allocate their memory.
+ *
+ * @param alloc : Callback to allocate a block of the given size, with 'ctx'
+ * passed as the last parameter. Blocks MUST be aligned as malloc() ones.
+ * @param realloc : Callback to resize a block from its old size to a new one,
+ * with 'ctx' passed as the last parameter. It may be NULL, in which case
+ * blocks are moved with 'alloc' and 'free'.
+ * @param free : Callback to free a block of the given size, with 'ctx' passed
+ * as the last parameter.
+ * @param ctx : Context passed to the callbacks, for example an arena.
+ *
+ * @note Callbacks are only called from the threads calling the containers API,
+ * never from the workers of parallel algorithms. An allocator used from one
+ * thread at a time does not need to be thread-safe.
+ */
+struct allocator {
+        allocator_alloc_cb alloc;
+        allocator_realloc_cb realloc;
+        allocator_free_cb free;
+        void *ctx;
+};
+
+/* API -----------------------------------------------------------------------*/
+
+/**
+ * @brief Returns the allocator used by containers created without one, which
+ * relies on malloc(), realloc() and free().
+ */
+const struct allocator *allocator_default(void);
+
+#endif /* LIB_ALLOCATORS_H */
@@ -8,6 +8,7 @@
 
 /* Includes ------------------------------------------------------------------*/
 
+#include "lib_allocators.h"
 #include "lib_iterators.h"
 #include "lib_types.h"
 
@@ -31,13 +32,32 @@ struct array;
 struct array *array_create(
                 const struct type_info *type, size_t count, void *data);
 
+/**
+ * @brief Creates an array over 'data' of 'count' elements of 'type', itself
+ * and its iterators being allocated from 'allocator'.
+ *
+ * @return Pointer to the new array on success.
+ * @return NULL if 'type', 'data' or 'allocator' are invalid.
+ * @return NULL if for 'type', 'size' is 0, 'copy' 'comp' or 'destroy' are
+ * invalid.
+ *
+ * @note 'allocator' MUST outlive the array and its iterators.
+ */
+struct array *array_create_with(
+                const struct type_info *type,
+                size_t count,
+                void *data,
+                const struct allocator *allocator);
+
 /**
  * @brief Destroys 'array'.
  */
 void array_destroy(const void *array);
 
 /**
- * @brief Sorts 'array' in ascending order.
+ * @brief Sorts 'array' in ascending order. Elements of type_int(), type_uint(),
+ * type_long(), type_ulong(), type_float() and type_double() are sorted by
+ * radix, elements of type_string() by multikey quicksort.
  *
  * @return 0 on success.
  * @return -EINVAL if 'array' is invalid.
@@ -52,6 +72,102 @@ int array_sort(struct array *array);
  */
 int array_sort_by(struct array *array, type_comp_cb comp);
 
+/**
+ * @brief Sorts 'array' in ascending order. Equal elements keep their relative
+ * order.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'array' is invalid.
+ * @return -ENOMEM on failure, in which case 'array' is left untouched.
+ */
+int array_stable_sort(struct array *array);
+
+/**
+ * @brief Sorts 'array' in ascending order following 'comp' rule. Equal
+ * elements keep their relative order.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'array' or 'comp' are invalid.
+ * @return -ENOMEM on failure, in which case 'array' is left untouched.
+ */
+int array_stable_sort_by(struct array *array, type_comp_cb comp);
+
+/**
+ * @brief Moves the 'k' lowest elements of 'array' to its beginning, sorted in
+ * ascending order. The order of the other elements is unspecified.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'array' is invalid.
+ * @return -ERANGE if 'k' is greater than the length of 'array'.
+ */
+int array_partial_sort(struct array *array, size_t k);
+
+/**
+ * @brief Moves to position 'k' of 'array' the element that would be there if
+ * 'array' was sorted. Elements before it are lower or equal, elements after it
+ * are greater or equal.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'array' is invalid.
+ * @return -ERANGE if 'k' is out of bounds.
+ */
+int array_nth_element(struct array *array, size_t k);
+
+/**
+ * @brief Sorts 'array' in ascending order, splitting the work between the
+ * threads used by parallel algorithms (see ctn_set_thread_count()). If
+ * 'stable' is true, equal elements keep their relative order.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'array' is invalid.
+ * @return -ENOMEM on failure, in which case 'array' is left untouched.
+ */
+int array_par_sort(struct array *array, bool stable);
+
+/**
+ * @brief Returns the position of the first element of 'array' which is not
+ * lower than 'value'. 'array' MUST be sorted in ascending order.
+ *
+ * @return The position found on success, the length of 'array' if every
+ * element is lower than 'value'.
+ * @return -EINVAL if 'array' or 'value' are invalid.
+ */
+ssize_t array_lower_bound(const struct array *array, const void *value);
+
+/**
+ * @brief Returns the position of the first element of 'array' which is greater
+ * than 'value'. 'array' MUST be sorted in ascending order.
+ *
+ * @return The position found on success, the length of 'array' if no element
+ * is greater than 'value'.
+ * @return -EINVAL if 'array' or 'value' are invalid.
+ */
+ssize_t array_upper_bound(const struct array *array, const void *value);
+
+/**
+ * @brief Indicates if 'array' contains an element equal to 'value'. 'array'
+ * MUST be sorted in ascending order.
+ *
+ * @return true if an element equal to 'value' was found.
+ * @return false if no element was found.
+ * @return false if 'array' or 'value' are invalid.
+ */
+bool array_binary_search(const struct array *array, const void *value);
+
+/**
+ * @brief Sets 'first' and 'last' to the bounds of the range of elements of
+ * 'array' equal to 'value', 'last' being excluded. 'array' MUST be sorted in
+ * ascending order.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'array', 'value', 'first' or 'last' are invalid.
+ */
+int array_equal_range(
+                const struct array *array,
+                const void *value,
+                size_t *first,
+                size_t *last);
+
 /**
  * @brief Returns the number of elements of 'array'.
  *
@@ -8,6 +8,8 @@
 
 /* Includes ------------------------------------------------------------------*/
 
+#include "lib_allocators.h"
+#include "lib_iterators.h"
 #include "lib_types.h"
 
 #include <stdbool.h>
@@ -29,6 +31,36 @@ struct buffer;
  */
 struct buffer *buffer_create(const struct type_info *type, size_t count);
 
+/**
+ * @brief Creates a new buffer of 'count' elements of type 'type' allocated
+ * from 'allocator'.
+ *
+ * @return Pointer to the new buffer on success.
+ * @return NULL if 'type' or 'allocator' are invalid or 'count' is 0.
+ * @return NULL if for 'type', 'size' is 0, 'copy' or 'destroy' are invalid.
+ *
+ * @note 'allocator' MUST outlive the buffer.
+ */
+struct buffer *buffer_create_with(
+                const struct type_info *type,
+                size_t count,
+                const struct allocator *allocator);
+
+/**
+ * @brief Creates a new mirrored buffer of at least 'count' elements of type
+ * 'type'. Its storage is mapped twice back-to-back in virtual memory, so that
+ * any run of values, or of free slots, is contiguous even when it wraps around
+ * the end of the buffer. The number of elements is rounded up for the storage
+ * to fill whole pages.
+ *
+ * @return Pointer to the new buffer on success.
+ * @return NULL if 'type' is invalid or 'count' is 0.
+ * @return NULL if for 'type', 'size' is 0, 'copy' or 'destroy' are invalid.
+ * @return NULL if the storage could not be mapped.
+ */
+struct buffer *buffer_create_mirrored(
+                const struct type_info *type, size_t count);
+
 /**
  * @brief Destroys 'buffer'.
  */
@@ -64,6 +96,110 @@ int buffer_f_push(struct buffer *buffer, const void *data);
  */
 int buffer_pop(struct buffer *buffer);
 
+/**
+ * @brief Adds as many of the 'n' values of 'data' into 'buffer' as there is
+ * room for, in order. Values are copied in at most two contiguous segments
+ * around the end of 'buffer'.
+ *
+ * @return The number of values added on success.
+ * @return -EINVAL if 'buffer' or 'data' are invalid.
+ */
+ssize_t buffer_push_n(struct buffer *buffer, const void *data, size_t n);
+
+/**
+ * @brief Removes the 'n' first values of 'buffer', or all of them if there are
+ * less. If 'data' is not NULL, the values are moved into it, which takes
+ * ownership of them, otherwise they are destroyed.
+ *
+ * @return The number of values removed on success.
+ * @return -EINVAL if 'buffer' is invalid.
+ */
+ssize_t buffer_pop_n(struct buffer *buffer, void *data, size_t n);
+
+/**
+ * @brief Copies bitwise the 'n' first values of 'buffer', or all of them if
+ * there are less, into 'data' without removing them.
+ *
+ * @return The number of values copied on success.
+ * @return -EINVAL if 'buffer' or 'data' are invalid.
+ *
+ * @warning Copied values still belong to 'buffer', and SHOULD NOT be used
+ * once they are removed from it.
+ */
+ssize_t buffer_peek_n(const struct buffer *buffer, void *data, size_t n);
+
+/**
+ * @brief Gives access to the values of 'buffer' stored contiguously in memory
+ * from the first one. 'data' is set to the first value. Values of a mirrored
+ * buffer are always all contiguous. They can be removed with buffer_pop_n().
+ *
+ * @return The number of contiguous values on success.
+ * @return -EINVAL if 'buffer' or 'data' are invalid.
+ */
+ssize_t buffer_read_span(const struct buffer *buffer, const void **data);
+
+/**
+ * @brief Gives access to the free slots of 'buffer' stored contiguously in
+ * memory after its last value. 'data' is set to the first slot. Free slots of
+ * a mirrored buffer are always all contiguous. Values written there are added
+ * to 'buffer' with buffer_commit().
+ *
+ * @return The number of contiguous free slots on success.
+ * @return -EINVAL if 'buffer' or 'data' are invalid.
+ *
+ * @note Values are written bitwise into slots, 'buffer' takes ownership of
+ * them once committed.
+ */
+ssize_t buffer_write_span(struct buffer *buffer, void **data);
+
+/**
+ * @brief Adds to 'buffer' the 'n' values written in the slots given by
+ * buffer_write_span().
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'buffer' is invalid.
+ * @return -ENOBUFS if 'n' is greater than the number of contiguous free slots.
+ */
+int buffer_commit(struct buffer *buffer, size_t n);
+
+/**
+ * @brief Reserves 'n' contiguous free slots after the last value of 'buffer',
+ * for the producer to write values directly inside 'buffer'. The values are
+ * added with buffer_commit().
+ *
+ * @return Pointer to the first slot on success.
+ * @return NULL if 'buffer' is invalid, if 'n' is 0, or if 'buffer' has less
+ * than 'n' contiguous free slots.
+ *
+ * @note Only mirrored buffers guarantee that all their free slots can be
+ * reserved at once.
+ */
+void *buffer_reserve(struct buffer *buffer, size_t n);
+
+/**
+ * @brief Gives access to the 'n' first values of 'buffer' if they are
+ * contiguous, for the consumer to read them in place. The values are removed
+ * with buffer_release().
+ *
+ * @return Pointer to the first value on success.
+ * @return NULL if 'buffer' is invalid, if 'n' is 0, or if 'buffer' has less
+ * than 'n' contiguous values.
+ *
+ * @note Only mirrored buffers guarantee that all their values can be acquired
+ * at once.
+ */
+const void *buffer_acquire(const struct buffer *buffer, size_t n);
+
+/**
+ * @brief Removes and destroys the 'n' first values of 'buffer', usually once
+ * read through buffer_acquire().
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'buffer' is invalid.
+ * @return -ENOMEM if 'buffer' has less than 'n' values.
+ */
+int buffer_release(struct buffer *buffer, size_t n);
+
 /**
  * @brief Clears 'buffer'.
  *
@@ -96,6 +232,25 @@ bool buffer_is_empty(const struct buffer *buffer);
  */
 bool buffer_is_full(const struct buffer *buffer);
 
+/**
+ * @brief Returns the value at 'pos' inside 'buffer', starting at 0 for its
+ * first value, without removing it.
+ *
+ * @return Pointer to the value on success.
+ * @return NULL if 'buffer' is invalid or 'pos' is out of bounds.
+ *
+ * @warning The returned pointer SHOULD NOT be used after 'buffer' is modified.
+ */
+void *buffer_at(const struct buffer *buffer, size_t pos);
+
+/**
+ * @brief Returns the number of values inside 'buffer'.
+ *
+ * @return Number of values inside 'buffer' on success.
+ * @return -EINVAL if 'buffer' is invalid.
+ */
+ssize_t buffer_len(const struct buffer *buffer);
+
 /**
  * @brief Returns the number of elements of 'buffer' defined at creation.
  *
@@ -104,4 +259,38 @@ bool buffer_is_full(const struct buffer *buffer);
  */
 ssize_t buffer_count(const struct buffer *buffer);
 
+/* Iterator API --------------------------------------------------------------*/
+
+/**
+ * @brief Creates an iterator over the first value of 'buffer'.
+ *
+ * @return Pointer to the iterator on success.
+ * @return NULL if 'buffer' is invalid or on failure.
+ */
+struct iterator *buffer_begin(const struct buffer *buffer);
+
+/**
+ * @brief Creates an iterator over the last value of 'buffer'.
+ *
+ * @return Pointer to the iterator on success.
+ * @return NULL if 'buffer' is invalid or on failure.
+ */
+struct iterator *buffer_end(const struct buffer *buffer);
+
+/**
+ * @brief Creates a reverse iterator over the last value of 'buffer'.
+ *
+ * @return Pointer to the iterator on success.
+ * @return NULL if 'buffer' is invalid or on failure.
+ */
+struct iterator *buffer_rbegin(const struct buffer *buffer);
+
+/**
+ * @brief Creates a reverse iterator over the first value of 'buffer'.
+ *
+ * @return Pointer to the iterator on success.
+ * @return NULL if 'buffer' is invalid or on failure.
+ */
+struct iterator *buffer_rend(const struct buffer *buffer);
+
 #endif /* LIB_BUFFERS_H */
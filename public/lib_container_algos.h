@@ -11,6 +11,7 @@
 #include "lib_iterators.h"
 
 #include <stdbool.h>
+#include <stddef.h>
 
 /* Definitions ---------------------------------------------------------------*/
 
@@ -164,6 +165,8 @@ bool ctn_contains_if(struct iterator *it, ctn_match_cb match, void *arg);
  *
  * @return 0 on success.
  * @return -EINVAL if 'it' or 'value' are invalid.
+ * @return -ENOTSUP if the elements of 'it' can not be overwritten, as the
+ * objects of an intrusive list.
  * @return -ENOMEM on failure.
  *
  * @note it_unref() is called on 'it' at the end for convenience.
@@ -217,4 +220,116 @@ int ctn_copy_min(struct iterator *it, void *value);
  */
 int ctn_copy_max(struct iterator *it, void *value);
 
+/**
+ * @brief Replaces the content of 'vector' with copies of the 'k' greatest
+ * elements starting from 'it', in descending order. Only 'k' elements are
+ * kept while iterating, which is cheaper than sorting all of them when 'k' is
+ * small.
+ *
+ * @return Pointer to a valid vector, if it was modified or not.
+ *
+ * @note If 'ret' is not NULL, its value will be modified to indicate if the
+ * operation was successful or not :
+ *      0 on success.
+ *      -EINVAL if 'it' or 'vector' are invalid, or if their types differ.
+ *      -ENOMEM on failure, in which case the content of 'vector' is
+ *      unspecified.
+ *
+ * @note it_unref() is called on 'it' at the end for convenience.
+ * Use it_ref() when sending an iterator you want to keep.
+ */
+void *ctn_top_k(struct iterator *it, size_t k, void *vector, int *ret);
+
+/* Parallel API --------------------------------------------------------------*/
+
+/*
+ * Parallel algorithms split the elements starting from 'it' between the
+ * threads of a pool owned by the library. Vectors and arrays are split in
+ * ranges of positions, maps in ranges of buckets. Other containers, reverse
+ * iterators and small ranges run sequentially.
+ *
+ * Callbacks given to these functions are called concurrently from several
+ * threads, and the elements MUST NOT be modified by other threads during the
+ * call. Parallel algorithms called from inside such a callback run
+ * sequentially on the calling thread.
+ *
+ * Results are the same as the ones of the sequential versions as long as the
+ * 'comp' callback of the elements type is a total order. It is not for
+ * floating point values containing NaN : ctn_par_min() and ctn_par_max() may
+ * then return another element than ctn_min() and ctn_max().
+ */
+
+/**
+ * @brief Sets the number of threads used by parallel algorithms, including
+ * the calling thread. If 'count' is 0, one thread per online CPU is used,
+ * which is also the default.
+ *
+ * @return 0 on success.
+ * @return -EBUSY if called from inside a callback of a parallel algorithm.
+ *
+ * @note This function waits for running parallel algorithms to complete.
+ */
+int ctn_set_thread_count(unsigned int count);
+
+/**
+ * @brief Parallel version of ctn_for_each(). The order in which elements are
+ * visited is unspecified.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'it' or 'action' are invalid.
+ * @return -ENOMEM on failure.
+ *
+ * @note it_unref() is called on 'it' at the end for convenience.
+ * Use it_ref() when sending an iterator you want to keep.
+ */
+int ctn_par_for_each(struct iterator *it, ctn_action_cb action, void *arg);
+
+/**
+ * @brief Parallel version of ctn_count_if().
+ *
+ * @return The number of matching elements on success.
+ * @return -EINVAL if 'it' or 'match' are invalid.
+ * @return -ENOMEM on failure.
+ *
+ * @note it_unref() is called on 'it' at the end for convenience.
+ * Use it_ref() when sending an iterator you want to keep.
+ */
+int ctn_par_count_if(struct iterator *it, ctn_match_cb match, void *arg);
+
+/**
+ * @brief Parallel version of ctn_fill().
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'it' or 'value' are invalid.
+ * @return -ENOTSUP if the elements of 'it' can not be overwritten, as the
+ * objects of an intrusive list.
+ * @return -ENOMEM on failure.
+ *
+ * @note it_unref() is called on 'it' at the end for convenience.
+ * Use it_ref() when sending an iterator you want to keep.
+ */
+int ctn_par_fill(struct iterator *it, const void *value);
+
+/**
+ * @brief Parallel version of ctn_min().
+ *
+ * @return Pointer to the iterator on success.
+ * @return NULL if 'it' is invalid or on failure.
+ *
+ * @note it_unref() is called on 'it' at the end for convenience.
+ * Use it_ref() when sending an iterator you want to keep.
+ */
+struct iterator *ctn_par_min(struct iterator *it);
+
+/**
+ * @brief Parallel version of ctn_max().
+ *
+ * @return Pointer to the iterator on success.
+ * @return NULL if 'it' is invalid or on failure.
+ *
+ * @note it_unref() is called on 'it' at the end for convenience.
+ * Use it_ref() when sending an iterator you want to keep.
+ */
+struct iterator *ctn_par_max(struct iterator *it);
+
 #endif /* LIB_CONTAINER_ALGOS_H */
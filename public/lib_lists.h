@@ -8,9 +8,11 @@
 
 /* Includes ------------------------------------------------------------------*/
 
+#include "lib_allocators.h"
 #include "lib_iterators.h"
 #include "lib_types.h"
 
+#include <stddef.h>
 #include <sys/types.h>
 
 /* Definitions ---------------------------------------------------------------*/
@@ -19,6 +21,26 @@ struct list;
 
 struct node;
 
+/**
+ * @brief Link embedded by callers inside their own objects to chain them in an
+ * intrusive list, see ilist_create().
+ *
+ * @note A link MUST be zeroed before its first insertion.
+ */
+struct list_link {
+        struct list_link *next;
+        struct list_link *previous;
+};
+
+/**
+ * @brief Returns a pointer to the object of 'type' embedding 'link' as its
+ * 'member' field.
+ */
+#define LIST_LINK_CONTAINER(link, type, member) \
+        ((type *)((char *)(link) - offsetof(type, member)))
+
+struct ilist;
+
 /* API -----------------------------------------------------------------------*/
 
 /**
@@ -30,6 +52,20 @@ struct node;
  */
 struct list *list_create(const struct type_info *type);
 
+/**
+ * @brief Creates an empty list of 'type' whose nodes and iterators are
+ * allocated from 'allocator'.
+ *
+ * @return Pointer to the created list on success.
+ * @return NULL if 'type' or 'allocator' are invalid.
+ * @return NULL if for 'type', 'size' is 0, 'copy' or 'destroy' are invalid.
+ *
+ * @note 'allocator' MUST outlive the list and its iterators.
+ */
+struct list *list_create_with(
+                const struct type_info *type,
+                const struct allocator *allocator);
+
 /**
  * @brief Destroys 'list'.
  */
@@ -87,6 +123,84 @@ int list_pop_back(struct list *list);
  */
 int list_remove(struct list *list, const struct node *node);
 
+/**
+ * @brief Moves the nodes from 'first' to 'last' included of 'src' before 'pos'
+ * inside 'dest', or at the end of 'dest' if 'pos' is NULL. Nodes are relinked
+ * without copying nor allocating any element, and stay valid.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'dest', 'src', 'first' or 'last' are invalid.
+ * @return -EINVAL if 'first' or 'last' are not nodes of 'src', or if 'pos' is
+ * not a node of 'dest'.
+ * @return -EINVAL if 'dest' and 'src' have different types or allocators.
+ *
+ * @note 'last' MUST be 'first' or follow it inside 'src'. If 'dest' and 'src'
+ * are the same list, 'pos' MUST NOT be between 'first' and 'last'.
+ * @note Moved nodes keep the memory of the list they were allocated from, and
+ * give it back when destroyed, even from another thread. Lists exchanging
+ * nodes may thus be protected by different locks, as long as both are held
+ * during the move. The memory of a destroyed list is kept until its nodes
+ * inside other lists are destroyed.
+ */
+int list_splice(
+                struct list *dest,
+                struct node *pos,
+                struct list *src,
+                struct node *first,
+                struct node *last);
+
+/**
+ * @brief Moves every node of 'src' at the end of 'dest', leaving 'src' empty.
+ * Nodes are relinked as with list_splice().
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'dest' or 'src' are invalid or are the same list.
+ * @return -EINVAL if 'dest' and 'src' have different types or allocators.
+ */
+int list_concat(struct list *dest, struct list *src);
+
+/**
+ * @brief Splits 'list' before 'node' : 'node' and the nodes following it are
+ * moved to a new list, relinked as with list_splice().
+ *
+ * @return Pointer to the new list on success.
+ * @return NULL if 'list' or 'node' are invalid, if 'node' is not a node of
+ * 'list', or on failure.
+ */
+struct list *list_split_at(struct list *list, struct node *node);
+
+/**
+ * @brief Sorts 'list' in ascending order following the 'comp' callback of its
+ * type. Equal elements keep their relative order. Nodes are relinked in place,
+ * without copying any element nor allocating memory.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'list' is invalid or if its type has no 'comp' callback.
+ */
+int list_sort(struct list *list);
+
+/**
+ * @brief Sorts 'list' in ascending order following 'comp' rule, as
+ * list_sort().
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'list' or 'comp' are invalid.
+ */
+int list_sort_by(struct list *list, type_comp_cb comp);
+
+/**
+ * @brief Moves every node of 'src' inside 'dest', both sorted in ascending
+ * order following the 'comp' callback of their type, so that 'dest' stays
+ * sorted. Equal elements of 'dest' come before the ones of 'src'. Nodes are
+ * relinked as with list_splice() and 'src' is left empty.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'dest' or 'src' are invalid or are the same list.
+ * @return -EINVAL if 'dest' and 'src' have different types or allocators, or
+ * if their type has no 'comp' callback.
+ */
+int list_merge(struct list *dest, struct list *src);
+
 /**
  * @brief Clears 'list'.
  *
@@ -193,4 +307,172 @@ struct iterator *list_rbegin(const struct list *list);
  */
 struct iterator *list_rend(const struct list *list);
 
+/* Intrusive list API --------------------------------------------------------*/
+
+/**
+ * @brief Creates an empty intrusive list of objects of 'type' embedding a
+ * struct list_link at 'offset'. The list never allocates, copies nor destroys
+ * its objects : inserting and removing them only relinks their link.
+ *
+ * @return Pointer to the created list on success.
+ * @return NULL if 'type' is invalid or on failure.
+ * @return NULL if for 'type', 'size' is too small to hold a link at 'offset'.
+ *
+ * @note Iterators over the list give access to the objects themselves, so that
+ * they can be used by ctn_*() algorithms reading them. Algorithms copying
+ * values into the elements, as ctn_fill(), are unsupported and return
+ * -ENOTSUP, since the copy would overwrite the link.
+ */
+struct ilist *ilist_create(const struct type_info *type, size_t offset);
+
+/**
+ * @brief Creates an empty intrusive list as ilist_create() whose iterators are
+ * allocated from 'allocator'.
+ *
+ * @return Pointer to the created list on success.
+ * @return NULL if 'type' or 'allocator' are invalid or on failure.
+ * @return NULL if for 'type', 'size' is too small to hold a link at 'offset'.
+ *
+ * @note 'allocator' MUST outlive the list and its iterators.
+ */
+struct ilist *ilist_create_with(
+                const struct type_info *type,
+                size_t offset,
+                const struct allocator *allocator);
+
+/**
+ * @brief Destroys 'ilist'. Its objects are removed as with ilist_clear(), so
+ * that they may be inserted again, and are otherwise left untouched.
+ */
+void ilist_destroy(const struct ilist *ilist);
+
+/**
+ * @brief Adds the object embedding 'link' at the beginning of 'ilist'.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'ilist' or 'link' are invalid.
+ * @return -EBUSY if 'link' is already inside a list.
+ */
+int ilist_push_front(struct ilist *ilist, struct list_link *link);
+
+/**
+ * @brief Adds the object embedding 'link' at the end of 'ilist'.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'ilist' or 'link' are invalid.
+ * @return -EBUSY if 'link' is already inside a list.
+ */
+int ilist_push_back(struct ilist *ilist, struct list_link *link);
+
+/**
+ * @brief Inserts the object embedding 'link' inside 'ilist' before the one
+ * embedding 'pos'.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'ilist', 'pos' or 'link' are invalid.
+ * @return -EINVAL if 'pos' is not inside a list.
+ * @return -EBUSY if 'link' is already inside a list.
+ *
+ * @note 'pos' MUST be a link of 'ilist'.
+ */
+int ilist_insert(
+                struct ilist *ilist,
+                struct list_link *pos,
+                struct list_link *link);
+
+/**
+ * @brief Removes the object embedding 'link' from 'ilist'. 'link' is zeroed
+ * and may be inserted again.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'ilist' or 'link' are invalid, or if 'link' is not inside
+ * a list.
+ *
+ * @note 'link' MUST be a link of 'ilist'.
+ */
+int ilist_remove(struct ilist *ilist, struct list_link *link);
+
+/**
+ * @brief Removes every object of 'ilist', zeroing their link.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'ilist' is invalid.
+ */
+int ilist_clear(struct ilist *ilist);
+
+/**
+ * @brief Returns the number of objects inside 'ilist'.
+ *
+ * @return The number of objects inside 'ilist' on success.
+ * @return -EINVAL if 'ilist' is invalid.
+ */
+ssize_t ilist_len(const struct ilist *ilist);
+
+/**
+ * @brief Returns the link of the first object of 'ilist'.
+ *
+ * @return Pointer to the link on success.
+ * @return NULL if 'ilist' is invalid or empty.
+ */
+struct list_link *ilist_first(const struct ilist *ilist);
+
+/**
+ * @brief Returns the link of the last object of 'ilist'.
+ *
+ * @return Pointer to the link on success.
+ * @return NULL if 'ilist' is invalid or empty.
+ */
+struct list_link *ilist_last(const struct ilist *ilist);
+
+/**
+ * @brief Returns the link following 'link' inside 'ilist'.
+ *
+ * @return Pointer to the link on success.
+ * @return NULL if 'ilist' or 'link' are invalid, or if 'link' is the last one.
+ */
+struct list_link *ilist_next(
+                const struct ilist *ilist, const struct list_link *link);
+
+/**
+ * @brief Returns the link preceding 'link' inside 'ilist'.
+ *
+ * @return Pointer to the link on success.
+ * @return NULL if 'ilist' or 'link' are invalid, or if 'link' is the first
+ * one.
+ */
+struct list_link *ilist_previous(
+                const struct ilist *ilist, const struct list_link *link);
+
+/**
+ * @brief Creates an iterator over the first object of 'ilist'.
+ *
+ * @return Pointer to the iterator on success.
+ * @return NULL if 'ilist' is invalid or on failure.
+ */
+struct iterator *ilist_begin(const struct ilist *ilist);
+
+/**
+ * @brief Creates an iterator over the last object of 'ilist'.
+ *
+ * @return Pointer to the iterator on success.
+ * @return NULL if 'ilist' is invalid or on failure.
+ */
+struct iterator *ilist_end(const struct ilist *ilist);
+
+/**
+ * @brief Creates a reverse iterator over the last object of 'ilist'.
+ *
+ * @return Pointer to the iterator on success.
+ * @return NULL if 'ilist' is invalid or on failure.
+ */
+struct iterator *ilist_rbegin(const struct ilist *ilist);
+
+/**
+ * @brief Creates a reverse iterator over the first object of 'ilist'.
+ *
+ * @return Pointer to the iterator on success.
+ * @return NULL if 'ilist' is invalid or on failure.
+ */
+struct iterator *ilist_rend(const struct ilist *ilist);
+
 #endif /* LIB_LISTS_H */
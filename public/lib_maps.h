@@ -8,6 +8,7 @@
 
 /* Includes ------------------------------------------------------------------*/
 
+#include "lib_allocators.h"
 #include "lib_iterators.h"
 #include "lib_types.h"
 
@@ -39,6 +40,24 @@ struct map *map_create(
                 const struct type_info *key_type,
                 const struct type_info *value_type);
 
+/**
+ * @brief Creates an empty map containing pairs of <'key_type', 'value_type'>
+ * whose nodes, buckets and iterators are allocated from 'allocator'.
+ *
+ * @return Pointer to the new map on success.
+ * @return NULL if 'key_type', 'value_type' or 'allocator' are invalid.
+ * @return NULL if for 'key_type', 'size' is 0, 'copy' 'comp' 'hash' or
+ * 'destroy' are invalid.
+ * @return NULL if for 'value_type', 'size' is 0, 'copy' or 'destroy' are
+ * invalid.
+ *
+ * @note 'allocator' MUST outlive the map and its iterators.
+ */
+struct map *map_create_with(
+                const struct type_info *key_type,
+                const struct type_info *value_type,
+                const struct allocator *allocator);
+
 /**
  * @brief Destroys 'map'.
  */
@@ -0,0 +1,128 @@
+/**
+ * @author Maxence ROBIN
+ * @brief Provides lock-free multi-producer multi-consumer bounded queues
+ */
+
+#ifndef LIB_MPMC_BUFFERS_H
+#define LIB_MPMC_BUFFERS_H
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_allocators.h"
+#include "lib_types.h"
+
+#include <stddef.h>
+#include <sys/types.h>
+
+/* Definitions ---------------------------------------------------------------*/
+
+/**
+ * @brief Bounded queue shared by any number of producer threads, calling
+ * mpmc_buffer_try_push(), and consumer threads, calling mpmc_buffer_try_pop(),
+ * without any lock. Each slot carries a sequence number telling whether it is
+ * ready to be written or read, so that producers and consumers only contend
+ * on their own index.
+ */
+struct mpmc_buffer;
+
+/* API -----------------------------------------------------------------------*/
+
+/**
+ * @brief Creates a new buffer of at least 'count' elements of type 'type'. The
+ * number of elements is rounded up to a power of two.
+ *
+ * @return Pointer to the new buffer on success.
+ * @return NULL if 'type' is invalid or 'count' is 0.
+ * @return NULL if for 'type', 'size' is 0, 'copy' or 'destroy' are invalid.
+ */
+struct mpmc_buffer *mpmc_buffer_create(
+                const struct type_info *type, size_t count);
+
+/**
+ * @brief Creates a new buffer of at least 'count' elements of type 'type'
+ * allocated from 'allocator', as mpmc_buffer_create().
+ *
+ * @return Pointer to the new buffer on success.
+ * @return NULL if 'type' or 'allocator' are invalid or 'count' is 0.
+ * @return NULL if for 'type', 'size' is 0, 'copy' or 'destroy' are invalid.
+ *
+ * @note 'allocator' MUST outlive the buffer.
+ */
+struct mpmc_buffer *mpmc_buffer_create_with(
+                const struct type_info *type,
+                size_t count,
+                const struct allocator *allocator);
+
+/**
+ * @brief Destroys 'buffer'.
+ *
+ * @note No producer nor consumer may use 'buffer' anymore.
+ */
+void mpmc_buffer_destroy(const struct mpmc_buffer *buffer);
+
+/**
+ * @brief Adds 'data' into 'buffer' if it is not full.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'buffer' or 'data' are invalid.
+ * @return -ENOBUFS if 'buffer' is full.
+ */
+int mpmc_buffer_try_push(struct mpmc_buffer *buffer, const void *data);
+
+/**
+ * @brief Moves the first value of 'buffer' into 'data', which takes ownership
+ * of it, if 'buffer' is not empty.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'buffer' or 'data' are invalid.
+ * @return -ENOMEM if 'buffer' is empty.
+ */
+int mpmc_buffer_try_pop(struct mpmc_buffer *buffer, void *data);
+
+/**
+ * @brief Adds 'data' into 'buffer' as mpmc_buffer_try_push(), waiting for a
+ * free slot if 'buffer' is full. Waiting threads sleep, and are only woken up
+ * when a value is removed.
+ *
+ * @param timeout : Maximum time to wait in milliseconds, forever if negative.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'buffer' or 'data' are invalid.
+ * @return -ETIMEDOUT if 'buffer' is still full after 'timeout'.
+ */
+int mpmc_buffer_push_wait(
+                struct mpmc_buffer *buffer, const void *data, int timeout);
+
+/**
+ * @brief Moves the first value of 'buffer' into 'data' as
+ * mpmc_buffer_try_pop(), waiting for a value if 'buffer' is empty. Waiting
+ * threads sleep, and are only woken up when a value is added.
+ *
+ * @param timeout : Maximum time to wait in milliseconds, forever if negative.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'buffer' or 'data' are invalid.
+ * @return -ETIMEDOUT if 'buffer' is still empty after 'timeout'.
+ */
+int mpmc_buffer_pop_wait(
+                struct mpmc_buffer *buffer, void *data, int timeout);
+
+/**
+ * @brief Returns the number of values inside 'buffer'. The result may already
+ * be outdated when used while other threads push or pop values.
+ *
+ * @return Number of values inside 'buffer' on success.
+ * @return -EINVAL if 'buffer' is invalid.
+ */
+ssize_t mpmc_buffer_len(const struct mpmc_buffer *buffer);
+
+/**
+ * @brief Returns the number of elements of 'buffer', once rounded at
+ * creation.
+ *
+ * @return Number of elements of 'buffer' on success.
+ * @return -EINVAL if 'buffer' is invalid.
+ */
+ssize_t mpmc_buffer_count(const struct mpmc_buffer *buffer);
+
+#endif /* LIB_MPMC_BUFFERS_H */
@@ -0,0 +1,157 @@
+/**
+ * @author Maxence ROBIN
+ * @brief Provides circular buffers of variable-length records
+ */
+
+#ifndef LIB_RECORD_BUFFERS_H
+#define LIB_RECORD_BUFFERS_H
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_allocators.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+/* Definitions ---------------------------------------------------------------*/
+
+typedef void (*record_cb)(const void *, size_t, void *);
+
+/**
+ * @brief Circular buffer of bytes storing records of any length, each one
+ * prefixed by its length and stored contiguously. Records are written in place
+ * by the producer and read in place by the consumer, so they are never
+ * allocated nor copied by the buffer.
+ *
+ * Functions are split between the producer side, record_buffer_reserve(),
+ * record_buffer_commit() and record_buffer_push(), and the consumer side,
+ * record_buffer_peek(), record_buffer_pop() and record_buffer_consume(). One
+ * producer thread and one consumer thread may use 'buffer' concurrently
+ * without any lock.
+ */
+struct record_buffer;
+
+/* API -----------------------------------------------------------------------*/
+
+/**
+ * @brief Creates a new buffer of at least 'size' bytes. The number of bytes is
+ * rounded up to a power of two.
+ *
+ * @return Pointer to the new buffer on success.
+ * @return NULL if 'size' is 0 or on failure.
+ */
+struct record_buffer *record_buffer_create(size_t size);
+
+/**
+ * @brief Creates a new buffer of at least 'size' bytes allocated from
+ * 'allocator', as record_buffer_create().
+ *
+ * @return Pointer to the new buffer on success.
+ * @return NULL if 'allocator' is invalid, 'size' is 0 or on failure.
+ *
+ * @note 'allocator' MUST outlive the buffer.
+ */
+struct record_buffer *record_buffer_create_with(
+                size_t size, const struct allocator *allocator);
+
+/**
+ * @brief Destroys 'buffer'.
+ *
+ * @note Neither the producer nor the consumer may use 'buffer' anymore.
+ */
+void record_buffer_destroy(const struct record_buffer *buffer);
+
+/**
+ * @brief Reserves room for a record of 'len' bytes after the last record of
+ * 'buffer', for the producer to write it in place. The record is added with
+ * record_buffer_commit(). A new reservation replaces the previous one.
+ *
+ * @return Pointer to the first byte of the record on success.
+ * @return NULL if 'buffer' is invalid, if 'len' is 0 or greater than
+ * record_buffer_max_len(), or if 'buffer' has not enough free room.
+ */
+void *record_buffer_reserve(struct record_buffer *buffer, size_t len);
+
+/**
+ * @brief Adds to 'buffer' the record of 'len' bytes written in the room given
+ * by record_buffer_reserve(). 'len' may be lower than the reserved length.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'buffer' is invalid or 'len' is 0.
+ * @return -ENOBUFS if 'len' is greater than the reserved length.
+ */
+int record_buffer_commit(struct record_buffer *buffer, size_t len);
+
+/**
+ * @brief Adds a copy of the 'len' bytes of 'data' as a record into 'buffer'.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'buffer' or 'data' are invalid, or if 'len' is 0 or
+ * greater than record_buffer_max_len().
+ * @return -ENOBUFS if 'buffer' has not enough free room.
+ */
+int record_buffer_push(
+                struct record_buffer *buffer, const void *data, size_t len);
+
+/**
+ * @brief Gives access to the first record of 'buffer', and sets 'len' to its
+ * length.
+ *
+ * @return Pointer to the first byte of the record on success.
+ * @return NULL if 'buffer' or 'len' are invalid, or if 'buffer' is empty.
+ *
+ * @warning The returned pointer SHOULD NOT be used after the record is
+ * removed.
+ */
+const void *record_buffer_peek(struct record_buffer *buffer, size_t *len);
+
+/**
+ * @brief Removes the first record of 'buffer'.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'buffer' is invalid.
+ * @return -ENOMEM if 'buffer' is empty.
+ */
+int record_buffer_pop(struct record_buffer *buffer);
+
+/**
+ * @brief Calls 'callback' on the 'n' first records of 'buffer', or all of them
+ * if there are less, in place, then removes them at once. 'callback' receives
+ * the record, its length and 'arg'.
+ *
+ * @return The number of records consumed on success.
+ * @return -EINVAL if 'buffer' or 'callback' are invalid.
+ */
+ssize_t record_buffer_consume(
+                struct record_buffer *buffer,
+                record_cb callback,
+                void *arg,
+                size_t n);
+
+/**
+ * @brief Indicates if 'buffer' is empty.
+ *
+ * @return true if 'buffer' is empty.
+ * @return false if 'buffer' is not empty OR if 'buffer' is invalid.
+ */
+bool record_buffer_is_empty(const struct record_buffer *buffer);
+
+/**
+ * @brief Returns the length of the longest record 'buffer' accepts, which
+ * always fits once 'buffer' is empty.
+ *
+ * @return Maximum length of a record on success.
+ * @return -EINVAL if 'buffer' is invalid.
+ */
+ssize_t record_buffer_max_len(const struct record_buffer *buffer);
+
+/**
+ * @brief Returns the number of bytes of 'buffer', once rounded at creation.
+ *
+ * @return Number of bytes of 'buffer' on success.
+ * @return -EINVAL if 'buffer' is invalid.
+ */
+ssize_t record_buffer_size(const struct record_buffer *buffer);
+
+#endif /* LIB_RECORD_BUFFERS_H */
@@ -0,0 +1,127 @@
+/**
+ * @author Maxence ROBIN
+ * @brief Provides lock-free single-producer single-consumer circular buffers
+ */
+
+#ifndef LIB_SPSC_BUFFERS_H
+#define LIB_SPSC_BUFFERS_H
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_allocators.h"
+#include "lib_types.h"
+
+#include <stddef.h>
+#include <sys/types.h>
+
+/* Definitions ---------------------------------------------------------------*/
+
+/**
+ * @brief Circular buffer shared by exactly one producer thread, calling
+ * spsc_buffer_push(), and one consumer thread, calling spsc_buffer_pop(),
+ * without any lock.
+ */
+struct spsc_buffer;
+
+/* API -----------------------------------------------------------------------*/
+
+/**
+ * @brief Creates a new buffer of at least 'count' elements of type 'type'. The
+ * number of elements is rounded up to a power of two.
+ *
+ * @return Pointer to the new buffer on success.
+ * @return NULL if 'type' is invalid or 'count' is 0.
+ * @return NULL if for 'type', 'size' is 0, 'copy' or 'destroy' are invalid.
+ */
+struct spsc_buffer *spsc_buffer_create(
+                const struct type_info *type, size_t count);
+
+/**
+ * @brief Creates a new buffer of at least 'count' elements of type 'type'
+ * allocated from 'allocator', as spsc_buffer_create().
+ *
+ * @return Pointer to the new buffer on success.
+ * @return NULL if 'type' or 'allocator' are invalid or 'count' is 0.
+ * @return NULL if for 'type', 'size' is 0, 'copy' or 'destroy' are invalid.
+ *
+ * @note 'allocator' MUST outlive the buffer.
+ */
+struct spsc_buffer *spsc_buffer_create_with(
+                const struct type_info *type,
+                size_t count,
+                const struct allocator *allocator);
+
+/**
+ * @brief Destroys 'buffer'.
+ *
+ * @note Neither the producer nor the consumer may use 'buffer' anymore.
+ */
+void spsc_buffer_destroy(const struct spsc_buffer *buffer);
+
+/**
+ * @brief Adds 'data' into 'buffer'. MUST only be called by the producer.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'buffer' or 'data' are invalid.
+ * @return -ENOBUFS if 'buffer' is full.
+ */
+int spsc_buffer_push(struct spsc_buffer *buffer, const void *data);
+
+/**
+ * @brief Moves the first value of 'buffer' into 'data', which takes ownership
+ * of it. MUST only be called by the consumer.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'buffer' or 'data' are invalid.
+ * @return -ENOMEM if 'buffer' is empty.
+ */
+int spsc_buffer_pop(struct spsc_buffer *buffer, void *data);
+
+/**
+ * @brief Adds 'data' into 'buffer' as spsc_buffer_push(), waiting for a
+ * free slot if 'buffer' is full. Waiting threads sleep, and are only woken up
+ * when a value is removed. MUST only be called by the producer.
+ *
+ * @param timeout : Maximum time to wait in milliseconds, forever if negative.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'buffer' or 'data' are invalid.
+ * @return -ETIMEDOUT if 'buffer' is still full after 'timeout'.
+ */
+int spsc_buffer_push_wait(
+                struct spsc_buffer *buffer, const void *data, int timeout);
+
+/**
+ * @brief Moves the first value of 'buffer' into 'data' as spsc_buffer_pop(),
+ * waiting for a value if 'buffer' is empty. Waiting threads sleep, and are
+ * only woken up when a value is added. MUST only be called by the consumer.
+ *
+ * @param timeout : Maximum time to wait in milliseconds, forever if negative.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'buffer' or 'data' are invalid.
+ * @return -ETIMEDOUT if 'buffer' is still empty after 'timeout'.
+ */
+int spsc_buffer_pop_wait(
+                struct spsc_buffer *buffer, void *data, int timeout);
+
+/**
+ * @brief Returns the number of values inside 'buffer'. The result may already
+ * be outdated when used by a thread that is neither the producer nor the
+ * consumer.
+ *
+ * @return Number of values inside 'buffer' on success.
+ * @return -EINVAL if 'buffer' is invalid.
+ */
+ssize_t spsc_buffer_len(const struct spsc_buffer *buffer);
+
+/**
+ * @brief Returns the number of elements of 'buffer', once rounded at
+ * creation.
+ *
+ * @return Number of elements of 'buffer' on success.
+ * @return -EINVAL if 'buffer' is invalid.
+ */
+ssize_t spsc_buffer_count(const struct spsc_buffer *buffer);
+
+#endif /* LIB_SPSC_BUFFERS_H */
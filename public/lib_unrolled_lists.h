@@ -0,0 +1,173 @@
+/**
+ * @author Maxence ROBIN
+ * @brief Provides unrolled doubly-linked list manipulation
+ */
+
+#ifndef LIB_UNROLLED_LISTS_H
+#define LIB_UNROLLED_LISTS_H
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_allocators.h"
+#include "lib_iterators.h"
+#include "lib_types.h"
+
+#include <sys/types.h>
+
+/* Definitions ---------------------------------------------------------------*/
+
+/**
+ * @brief Doubly-linked list of chunks, each one storing several elements next
+ * to each other. Walking the list touches one chunk per few cache lines of
+ * elements instead of one node per element, and positional accesses skip whole
+ * chunks at once.
+ */
+struct ulist;
+
+/* API -----------------------------------------------------------------------*/
+
+/**
+ * @brief Creates an empty unrolled list of 'type'.
+ *
+ * @return Pointer to the created list on success.
+ * @return NULL if 'type' is invalid.
+ * @return NULL if for 'type', 'size' is 0, 'copy' or 'destroy' are invalid.
+ */
+struct ulist *ulist_create(const struct type_info *type);
+
+/**
+ * @brief Creates an empty unrolled list of 'type' whose chunks and iterators
+ * are allocated from 'allocator'.
+ *
+ * @return Pointer to the created list on success.
+ * @return NULL if 'type' or 'allocator' are invalid.
+ * @return NULL if for 'type', 'size' is 0, 'copy' or 'destroy' are invalid.
+ *
+ * @note 'allocator' MUST outlive the list and its iterators.
+ */
+struct ulist *ulist_create_with(
+                const struct type_info *type,
+                const struct allocator *allocator);
+
+/**
+ * @brief Destroys 'ulist'.
+ */
+void ulist_destroy(const struct ulist *ulist);
+
+/**
+ * @brief Adds 'value' at the beginning of 'ulist'.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'ulist' or 'value' are invalid.
+ * @return -ENOMEM on failure.
+ */
+int ulist_push_front(struct ulist *ulist, const void *value);
+
+/**
+ * @brief Adds 'value' at the end of 'ulist'.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'ulist' or 'value' are invalid.
+ * @return -ENOMEM on failure.
+ */
+int ulist_push_back(struct ulist *ulist, const void *value);
+
+/**
+ * @brief Inserts 'value' at 'pos' inside 'ulist'.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'ulist' or 'value' are invalid.
+ * @return -ERANGE if 'pos' is out of bounds.
+ * @return -ENOMEM on failure.
+ */
+int ulist_insert(struct ulist *ulist, unsigned int pos, const void *value);
+
+/**
+ * @brief Removes the first element of 'ulist'.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'ulist' is invalid.
+ * @return -ENOBUFS if 'ulist' is already empty.
+ */
+int ulist_pop_front(struct ulist *ulist);
+
+/**
+ * @brief Removes the last element of 'ulist'.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'ulist' is invalid.
+ * @return -ENOBUFS if 'ulist' is already empty.
+ */
+int ulist_pop_back(struct ulist *ulist);
+
+/**
+ * @brief Removes the element at 'pos' inside 'ulist'.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'ulist' is invalid.
+ * @return -ERANGE if 'pos' is out of bounds.
+ */
+int ulist_remove(struct ulist *ulist, unsigned int pos);
+
+/**
+ * @brief Clears 'ulist'.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'ulist' is invalid.
+ */
+int ulist_clear(struct ulist *ulist);
+
+/**
+ * @brief Returns the number of elements inside 'ulist'.
+ *
+ * @return The number of elements inside 'ulist' on success.
+ * @return -EINVAL if 'ulist' is invalid.
+ */
+ssize_t ulist_len(const struct ulist *ulist);
+
+/**
+ * @brief Returns the element at 'pos' inside 'ulist', starting at 0. Whole
+ * chunks are skipped from the closest end of 'ulist'.
+ *
+ * @return Pointer to the element on success.
+ * @return NULL if 'ulist' is invalid or 'pos' is out of bounds.
+ *
+ * @warning The returned pointer SHOULD NOT be used after 'ulist' is modified.
+ */
+void *ulist_at(const struct ulist *ulist, unsigned int pos);
+
+/* Iterator API --------------------------------------------------------------*/
+
+/**
+ * @brief Creates an iterator over the first element of 'ulist'.
+ *
+ * @return Pointer to the iterator on success.
+ * @return NULL if 'ulist' is invalid or on failure.
+ */
+struct iterator *ulist_begin(const struct ulist *ulist);
+
+/**
+ * @brief Creates an iterator over the last element of 'ulist'.
+ *
+ * @return Pointer to the iterator on success.
+ * @return NULL if 'ulist' is invalid or on failure.
+ */
+struct iterator *ulist_end(const struct ulist *ulist);
+
+/**
+ * @brief Creates a reverse iterator over the last element of 'ulist'.
+ *
+ * @return Pointer to the iterator on success.
+ * @return NULL if 'ulist' is invalid or on failure.
+ */
+struct iterator *ulist_rbegin(const struct ulist *ulist);
+
+/**
+ * @brief Creates a reverse iterator over the first element of 'ulist'.
+ *
+ * @return Pointer to the iterator on success.
+ * @return NULL if 'ulist' is invalid or on failure.
+ */
+struct iterator *ulist_rend(const struct ulist *ulist);
+
+#endif /* LIB_UNROLLED_LISTS_H */
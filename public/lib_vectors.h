@@ -8,12 +8,23 @@
 
 /* Includes ------------------------------------------------------------------*/
 
+#include "lib_allocators.h"
 #include "lib_iterators.h"
 #include "lib_types.h"
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <sys/types.h>
 
+/* Definitions ---------------------------------------------------------------*/
+
+/* Bytes reserved for the vector header at the beginning of a storage */
+#define VECTOR_STORAGE_HEADER 64
+
+/* Size of a storage holding up to 'count' elements of the C type 'type' */
+#define VECTOR_STORAGE_SIZE(type, count) \
+        (VECTOR_STORAGE_HEADER + (count) * sizeof(type))
+
 /* API -----------------------------------------------------------------------*/
 
 /**
@@ -26,11 +37,93 @@
  */
 void *vector_create(const struct type_info *type, size_t count);
 
+/**
+ * @brief Creates a vector of 'count' elements of 'type' whose storage and
+ * iterators are allocated from 'allocator'.
+ *
+ * @return Pointer to the new vector on success.
+ * @return NULL if 'type' or 'allocator' are invalid, or on failure.
+ * @return NULL if for 'type', 'size' is 0, 'copy' 'comp' or 'destroy' are
+ * invalid.
+ *
+ * @note 'allocator' MUST outlive the vector and its iterators.
+ */
+void *vector_create_with(
+                const struct type_info *type,
+                size_t count,
+                const struct allocator *allocator);
+
+/**
+ * @brief Creates a vector of 'count' elements of 'type' whose elements are
+ * aligned on 'alignment' bytes, e.g. 32 or 64 for vectorized loads or to keep
+ * elements within cache lines. The alignment is kept when the vector grows.
+ *
+ * @return Pointer to the new vector on success.
+ * @return NULL if 'type' is invalid or on failure.
+ * @return NULL if 'alignment' is not a power of 2.
+ * @return NULL if for 'type', 'size' is 0, 'copy' 'comp' or 'destroy' are
+ * invalid.
+ */
+void *vector_create_aligned(
+                const struct type_info *type,
+                size_t count,
+                size_t alignment);
+
+/**
+ * @brief Creates a vector of 'count' elements of 'type' whose storage is
+ * mapped directly from the system and backed by 2 MB transparent huge pages
+ * when available, which reduces TLB misses when scanning large vectors. Its
+ * capacity is rounded up to a whole number of huge pages and elements are
+ * aligned on 64 bytes. Growing such a vector remaps it without copying the
+ * elements.
+ *
+ * @return Pointer to the new vector on success.
+ * @return NULL if 'type' is invalid or on failure.
+ * @return NULL if for 'type', 'size' is 0, 'copy' 'comp' or 'destroy' are
+ * invalid.
+ *
+ * @note This is only worth it for vectors of several MB, smaller ones still
+ * use at least one huge page.
+ */
+void *vector_create_huge(const struct type_info *type, size_t count);
+
+/**
+ * @brief Creates a vector of 'count' elements of 'type' inside 'storage', a
+ * caller-owned buffer of 'storage_size' bytes, typically declared on the stack
+ * with VECTOR_STORAGE_SIZE(). No memory is allocated until the vector grows
+ * beyond the capacity of 'storage', at which point its elements are moved to
+ * the heap. 'storage' is never freed by the library.
+ *
+ * @return Pointer to the new vector on success.
+ * @return NULL if 'type' or 'storage' are invalid.
+ * @return NULL if 'storage_size' is lower than VECTOR_STORAGE_HEADER.
+ * @return NULL if 'storage' is not aligned as _Alignas(max_align_t).
+ * @return NULL if for 'type', 'size' is 0, 'copy' 'comp' or 'destroy' are
+ * invalid.
+ *
+ * @note 'storage' MUST outlive the vector. If it cannot hold 'count'
+ * elements, the vector is created on the heap.
+ */
+void *vector_create_small(
+                const struct type_info *type,
+                size_t count,
+                void *storage,
+                size_t storage_size);
+
 /**
  * @brief Destroys 'vector'.
  */
 void vector_destroy(const void *vector);
 
+/**
+ * @brief Indicates if the elements of 'vector' are still held by the storage
+ * given to vector_create_small().
+ *
+ * @return true if 'vector' uses its inline storage.
+ * @return false if 'vector' is on the heap or invalid.
+ */
+bool vector_is_inline(const void *vector);
+
 /**
  * @brief Adds the value pointer by 'data' at the end of 'vector'.
  *
@@ -77,7 +170,9 @@ void *vector_insert(void *vector, unsigned int pos, const void *data, int *ret);
 int vector_remove(void *vector, unsigned int pos);
 
 /**
- * @brief Sorts 'vector' in ascending order.
+ * @brief Sorts 'vector' in ascending order. Elements of type_int(),
+ * type_uint(), type_long(), type_ulong(), type_float() and type_double() are
+ * sorted by radix, elements of type_string() by multikey quicksort.
  *
  * @return 0 on success.
  * @return -EINVAL if 'vector' is invalid.
@@ -92,6 +187,102 @@ int vector_sort(void *vector);
  */
 int vector_sort_by(void *vector, type_comp_cb comp);
 
+/**
+ * @brief Sorts 'vector' in ascending order. Equal elements keep their relative
+ * order.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'vector' is invalid.
+ * @return -ENOMEM on failure, in which case 'vector' is left untouched.
+ */
+int vector_stable_sort(void *vector);
+
+/**
+ * @brief Sorts 'vector' in ascending order following 'comp' rule. Equal
+ * elements keep their relative order.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'vector' or 'comp' are invalid.
+ * @return -ENOMEM on failure, in which case 'vector' is left untouched.
+ */
+int vector_stable_sort_by(void *vector, type_comp_cb comp);
+
+/**
+ * @brief Moves the 'k' lowest elements of 'vector' to its beginning, sorted in
+ * ascending order. The order of the other elements is unspecified.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'vector' is invalid.
+ * @return -ERANGE if 'k' is greater than the length of 'vector'.
+ */
+int vector_partial_sort(void *vector, size_t k);
+
+/**
+ * @brief Moves to position 'k' of 'vector' the element that would be there if
+ * 'vector' was sorted. Elements before it are lower or equal, elements after it
+ * are greater or equal.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'vector' is invalid.
+ * @return -ERANGE if 'k' is out of bounds.
+ */
+int vector_nth_element(void *vector, size_t k);
+
+/**
+ * @brief Sorts 'vector' in ascending order, splitting the work between the
+ * threads used by parallel algorithms (see ctn_set_thread_count()). If
+ * 'stable' is true, equal elements keep their relative order.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'vector' is invalid.
+ * @return -ENOMEM on failure, in which case 'vector' is left untouched.
+ */
+int vector_par_sort(void *vector, bool stable);
+
+/**
+ * @brief Returns the position of the first element of 'vector' which is not
+ * lower than 'value'. 'vector' MUST be sorted in ascending order.
+ *
+ * @return The position found on success, the length of 'vector' if every
+ * element is lower than 'value'.
+ * @return -EINVAL if 'vector' or 'value' are invalid.
+ */
+ssize_t vector_lower_bound(const void *vector, const void *value);
+
+/**
+ * @brief Returns the position of the first element of 'vector' which is greater
+ * than 'value'. 'vector' MUST be sorted in ascending order.
+ *
+ * @return The position found on success, the length of 'vector' if no element
+ * is greater than 'value'.
+ * @return -EINVAL if 'vector' or 'value' are invalid.
+ */
+ssize_t vector_upper_bound(const void *vector, const void *value);
+
+/**
+ * @brief Indicates if 'vector' contains an element equal to 'value'. 'vector'
+ * MUST be sorted in ascending order.
+ *
+ * @return true if an element equal to 'value' was found.
+ * @return false if no element was found.
+ * @return false if 'vector' or 'value' are invalid.
+ */
+bool vector_binary_search(const void *vector, const void *value);
+
+/**
+ * @brief Sets 'first' and 'last' to the bounds of the range of elements of
+ * 'vector' equal to 'value', 'last' being excluded. 'vector' MUST be sorted in
+ * ascending order.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'vector', 'value', 'first' or 'last' are invalid.
+ */
+int vector_equal_range(
+                const void *vector,
+                const void *value,
+                size_t *first,
+                size_t *last);
+
 /**
  * @brief Removes all elements from 'vector".
  *
@@ -0,0 +1,150 @@
+/**
+ * @author Maxence ROBIN
+ * @brief Provides circular buffers keeping aggregates of their values
+ */
+
+#ifndef LIB_WINDOW_BUFFERS_H
+#define LIB_WINDOW_BUFFERS_H
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "lib_allocators.h"
+#include "lib_types.h"
+
+#include <stddef.h>
+#include <sys/types.h>
+
+/* Definitions ---------------------------------------------------------------*/
+
+/**
+ * @brief Circular buffer holding the last values pushed into it, as a sliding
+ * window. Its lowest and greatest values, and for built-in numeric types the
+ * sum of its values, are updated on each push instead of being computed again
+ * over the whole window.
+ */
+struct window_buffer;
+
+/* API -----------------------------------------------------------------------*/
+
+/**
+ * @brief Creates a new window buffer of 'count' elements of type 'type'.
+ *
+ * @return Pointer to the new buffer on success.
+ * @return NULL if 'type' is invalid or 'count' is 0.
+ * @return NULL if for 'type', 'size' is 0, 'copy', 'comp' or 'destroy' are
+ * invalid.
+ */
+struct window_buffer *window_buffer_create(
+                const struct type_info *type, size_t count);
+
+/**
+ * @brief Creates a new window buffer of 'count' elements of type 'type'
+ * allocated from 'allocator'.
+ *
+ * @return Pointer to the new buffer on success.
+ * @return NULL if 'type' or 'allocator' are invalid or 'count' is 0.
+ * @return NULL if for 'type', 'size' is 0, 'copy', 'comp' or 'destroy' are
+ * invalid.
+ *
+ * @note 'allocator' MUST outlive the buffer.
+ */
+struct window_buffer *window_buffer_create_with(
+                const struct type_info *type,
+                size_t count,
+                const struct allocator *allocator);
+
+/**
+ * @brief Destroys 'buffer'.
+ */
+void window_buffer_destroy(const struct window_buffer *buffer);
+
+/**
+ * @brief Adds 'data' into 'buffer', and overwrites its oldest value if
+ * 'buffer' is already full. Aggregates are updated in amortized constant time.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'buffer' or 'data' are invalid.
+ */
+int window_buffer_push(struct window_buffer *buffer, const void *data);
+
+/**
+ * @brief Returns the lowest value of 'buffer', the newest one if several are
+ * equal.
+ *
+ * @return Pointer to the value on success.
+ * @return NULL if 'buffer' is invalid or if 'buffer' is empty.
+ *
+ * @warning The returned pointer SHOULD NOT be used after 'buffer' is modified.
+ */
+const void *window_buffer_min(const struct window_buffer *buffer);
+
+/**
+ * @brief Returns the greatest value of 'buffer', the newest one if several are
+ * equal.
+ *
+ * @return Pointer to the value on success.
+ * @return NULL if 'buffer' is invalid or if 'buffer' is empty.
+ *
+ * @warning The returned pointer SHOULD NOT be used after 'buffer' is modified.
+ */
+const void *window_buffer_max(const struct window_buffer *buffer);
+
+/**
+ * @brief Sets 'sum' to the sum of the values of 'buffer'. Only built-in numeric
+ * types are supported. Sums of integers are exact until converted, sums of
+ * floating point values are computed again once per lap of 'buffer' to bound
+ * rounding errors.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'buffer' or 'sum' are invalid.
+ * @return -ENOTSUP if the type of 'buffer' is not a built-in numeric type.
+ */
+int window_buffer_sum(const struct window_buffer *buffer, double *sum);
+
+/**
+ * @brief Sets 'mean' to the mean of the values of 'buffer', as
+ * window_buffer_sum().
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'buffer' or 'mean' are invalid.
+ * @return -ENOTSUP if the type of 'buffer' is not a built-in numeric type.
+ * @return -ENOMEM if 'buffer' is empty.
+ */
+int window_buffer_mean(const struct window_buffer *buffer, double *mean);
+
+/**
+ * @brief Returns the value at 'pos' inside 'buffer', starting at 0 for its
+ * oldest value.
+ *
+ * @return Pointer to the value on success.
+ * @return NULL if 'buffer' is invalid or 'pos' is out of bounds.
+ *
+ * @warning The returned pointer SHOULD NOT be used after 'buffer' is modified.
+ */
+const void *window_buffer_at(const struct window_buffer *buffer, size_t pos);
+
+/**
+ * @brief Clears 'buffer'.
+ *
+ * @return 0 on success.
+ * @return -EINVAL if 'buffer' is invalid.
+ */
+int window_buffer_clear(struct window_buffer *buffer);
+
+/**
+ * @brief Returns the number of values inside 'buffer'.
+ *
+ * @return Number of values inside 'buffer' on success.
+ * @return -EINVAL if 'buffer' is invalid.
+ */
+ssize_t window_buffer_len(const struct window_buffer *buffer);
+
+/**
+ * @brief Returns the number of elements of 'buffer' defined at creation.
+ *
+ * @return Number of elements of 'buffer' on success.
+ * @return -EINVAL if 'buffer' is invalid.
+ */
+ssize_t window_buffer_count(const struct window_buffer *buffer);
+
+#endif /* LIB_WINDOW_BUFFERS_H */